@@ -40,6 +40,31 @@
 //           the data array and used (if properly initialized and
 //           maintained) should tell which elements of the data
 //           array are actually relevant.
+// (7) The member variable sortedPos holds a cached "sorted view" of
+//     the IntSet: when sortedValid is true, data[sortedPos[0]],
+//     data[sortedPos[1]], ..., data[sortedPos[used - 1]] are the
+//     relevant values in ascending order. The view is built lazily by
+//     the set operations and marked stale by every mutator.
+//     Note: sortedPos and sortedValid are mutable because building
+//           the view doesn't change the collection the IntSet
+//           represents, so const set operations may do it.
+//
+// DOCUMENTATION for private member (helper) functions:
+//   void sortView() const
+//     Pre:  (none)
+//     Post: If sortedValid was false, sortedPos has been rebuilt (by
+//           insertion sort, as there are at most MAX_SIZE values) and
+//           sortedValid is true.
+//   int matchSorted(const IntSet& otherIntSet,
+//                   bool* thisHit, bool* otherHit) const
+//     Pre:  thisHit (if not 0) has used elements set to false and
+//           otherHit (if not 0) has otherIntSet.size() elements set
+//           to false.
+//     Post: The # of values common to the invoking IntSet and
+//           otherIntSet is returned; for each common value, the
+//           element of thisHit (of otherHit) at the value's position
+//           in data (in otherIntSet.data) has been set to true. The
+//           two sorted views are merged in O(n + m) time.
 
 #include "IntSet.h"
 #include <iostream>
@@ -49,6 +74,54 @@ using namespace std;
 IntSet::IntSet()
 {
     used = 0;
+    sortedValid = false;
+}
+
+void IntSet::sortView() const
+{
+    if( sortedValid )
+        return;
+
+    // insertion sort the positions by the values they refer to
+    for( int i = 0; i < used; i ++ )
+    {
+        int j = i;
+        while( j > 0 && data[sortedPos[j - 1]] > data[i] )
+        {
+            sortedPos[j] = sortedPos[j - 1];
+            j --;
+        }
+        sortedPos[j] = i;
+    }
+    sortedValid = true;
+}
+
+int IntSet::matchSorted(const IntSet& otherIntSet,
+                        bool* thisHit, bool* otherHit) const
+{
+    sortView();
+    otherIntSet.sortView();
+
+    int i = 0, j = 0, common = 0;
+    while( i < used && j < otherIntSet.used )
+    {
+        int a = data[sortedPos[i]];
+        int b = otherIntSet.data[otherIntSet.sortedPos[j]];
+
+        if( a < b )
+            i ++;
+        else if( b < a )
+            j ++;
+        else // value is in both sets, so flag it on both sides
+        {
+            if( thisHit )  thisHit[sortedPos[i]] = true;
+            if( otherHit ) otherHit[otherIntSet.sortedPos[j]] = true;
+            common ++;
+            i ++;
+            j ++;
+        }
+    }
+    return common;
 }
 
 int IntSet::size() const
@@ -79,30 +152,12 @@ bool IntSet::contains(int anInt) const
 
 bool IntSet::isSubsetOf(const IntSet& otherIntSet) const
 {
-    int foundCount = 0;
-    
     if( this->isEmpty() )
         return true;
-	else if( this->size() > otherIntSet.size() )
-	{
-	    return false;
-	}
-	else
-    {
-        for( int thisI = 0; thisI < this->size(); thisI ++ )
-        {
-            for( int otherI = 0 ; otherI < otherIntSet.size(); otherI ++ )
-            {
-                if( this->data[thisI] == otherIntSet.data[otherI] )
-                    foundCount ++;
-            }
-        }
-        
-        if( foundCount == this->size() )  
-            return true;
-        else 
-            return false;
-	}
+    else if( this->size() > otherIntSet.size() )
+        return false;
+    else // a subset shares all of its values with otherIntSet
+        return ( matchSorted(otherIntSet, 0, 0) == this->size() );
 }
 
 void IntSet::DumpData(ostream& out) const
@@ -117,116 +172,69 @@ void IntSet::DumpData(ostream& out) const
 
 IntSet IntSet::unionWith(const IntSet& otherIntSet) const
 {
-    assert( ( this->size() + (otherIntSet.subtract(*this)).size() ) <= MAX_SIZE );
+    bool otherHit[MAX_SIZE] = { false };
+    int common = matchSorted(otherIntSet, 0, otherHit);
+
+    assert( ( this->size() + otherIntSet.size() - common ) <= MAX_SIZE );
     
     IntSet tempArray;
-    int tempIndex = 0;
-    bool tempFlag = false;
 
     // copy this IntSet into tempArray
     for( int i = 0; i < this->size(); i ++ )
     {
-        tempArray.data[tempIndex] = this->data[i];
-	tempArray.used ++;
-        tempIndex ++;
+        tempArray.data[tempArray.used] = this->data[i];
+        tempArray.used ++;
     }
     
     // add contents of otherIntSet to tempArray, ignoring dupes
     for( int i2 = 0; i2 < otherIntSet.size(); i2 ++ )
     {
-        for( int i = 0; i < this->size(); i ++ )
-	{
-	    if( otherIntSet.data[i2] == this->data[i] )
-	    {
-	        tempFlag = true;	// flag data matches (we don't want dupes)
-	    }
-	}
-
-        if( !tempFlag )				
-        {	
-	    tempArray.data[tempIndex] =	otherIntSet.data[i2]; // save the unique data
-	    tempArray.used ++; // increment used
-            tempIndex ++; // increment index
-	}   
-		
-	tempFlag = false; // reset tempFlag for next iteration
-    }    
+        if( !otherHit[i2] )
+        {
+            tempArray.data[tempArray.used] = otherIntSet.data[i2]; // save the unique data
+            tempArray.used ++;
+        }
+    }
           
     return tempArray;   
 }
 
 IntSet IntSet::intersect(const IntSet& otherIntSet) const
 {
-    IntSet tempArray;	 // create a temp IntSet object 
-			 // to hold the intersection values
-    int tempIndex = 0;
-    int strikeCount = 0; // var to count # times that
-			 // a value in IntSet does not
-			 // match a value in otherIntSet
-    bool removeSuccess;  // flag handle to call remove()
+    bool thisHit[MAX_SIZE] = { false };
+    matchSorted(otherIntSet, thisHit, 0);
 
-    // copy this IntSet into tempArray
+    IntSet tempArray;    // create a temp IntSet object 
+                         // to hold the intersection values
+
+    // copy over (in order) only the values also found in otherIntSet
     for( int i = 0; i < this->size(); i ++ )
     {
-        tempArray.data[tempIndex] = this->data[i];
-	tempArray.used ++;
-        tempIndex ++;
+        if( thisHit[i] )
+        {
+            tempArray.data[tempArray.used] = this->data[i];
+            tempArray.used ++;
+        }
     }
-    
-    // remove the contents of tempArray if they're not contained
-    // in the intersection of thisIntSet and otherIntSet
-    for( int i = 0; i < this->size(); i ++ )
-    {
-	for( int i2 = 0; i2 < otherIntSet.size(); i2 ++ )
-	{
-	    if( this->data[i] != otherIntSet.data[i2] )
-	        strikeCount ++;
-	}
-
-	if( strikeCount == otherIntSet.size() )
-	{
-	    // strikeCount == otherIntSet.size(), then the
-	    // IntSet value was not found in otherIntSet, so
-	    // it's not part of the intersection and should be
-	    // removed. . . 
-	    removeSuccess = ( tempArray.remove(this->data[i]) ); // remove the value
-	}
-
-	if( removeSuccess )  // here, i'm just using var f in a statement
-	                     // in order to get rid of a compiler warning; 
-	    strikeCount = 0; // reset the strike count for the next iteration
-	else
-	    strikeCount = 0;
-        }    
           
     return tempArray; // return intersection values
 }
 
 IntSet IntSet::subtract(const IntSet& otherIntSet) const
 {
+    bool thisHit[MAX_SIZE] = { false };
+    matchSorted(otherIntSet, thisHit, 0);
+
     // create temporary array object to hold values unique to this intSet
     IntSet tempArray;		
-    int tempIndex = 0;
-    bool tempFlag = false; // the tempFlag marks dupes
 
     for( int i = 0; i < this->size(); i ++ )
     {
-        for( int i2 = 0; i2 < otherIntSet.size(); i2 ++ )
+        if( !thisHit[i] ) // no dupe in otherIntSet, so keep the value
         {
-            if( this->data[i] == otherIntSet.data[i2] )
-            {
-	        tempFlag = true; // if flag data matches, then true 
-            }
-	}
-        
-        if( !tempFlag ) // if tempFlag == false, then there's no dupes, so
-        {	
-	    tempArray.data[tempIndex] =	this->data[i]; // save the unique data 
-	    tempArray.used ++; // increment the used variable
-	    tempIndex ++; // increment the element index
-	}   
-		
-        tempFlag = false; // reset the tempFlag for next iteration
+            tempArray.data[tempArray.used] = this->data[i];
+            tempArray.used ++;
+        }
     }    
     
     return tempArray; // return the IntSet obj
@@ -235,6 +243,7 @@ IntSet IntSet::subtract(const IntSet& otherIntSet) const
 void IntSet::reset()
 {
     used = 0; // set the # relevant elements to 0
+    sortedValid = false;
 }
 
 bool IntSet::add(int anInt)
@@ -245,6 +254,7 @@ bool IntSet::add(int anInt)
     {
         data[used] = anInt; // if anInt doesn't exist in the intSet,
         used ++;            // then add it to the end of the intSet
+        sortedValid = false;
         return true;        // and return true.
     }
     else
@@ -262,6 +272,7 @@ bool IntSet::remove(int anInt)
                 if( i == ( used - 1 ) )     // now, if anInt occurs at the end of the intSet,
                 {
                     used --;                // we're done, so decrement the used variable
+                    sortedValid = false;
                     return true;            // and return true;
                 }   
                 else                        // else, make a hole where anInt is located
@@ -271,6 +282,7 @@ bool IntSet::remove(int anInt)
                         data[i2] = data[i2 + 1];        // all trailing relevant values to the left; 
                     }
                     used --;                // now, we're done, so decrement the used variable    
+                    sortedValid = false;
                     return true;            // and return true; 
                 }
             }
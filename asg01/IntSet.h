@@ -114,6 +114,11 @@ public:
 private:
    int data[MAX_SIZE];
    int used;
+   mutable int sortedPos[MAX_SIZE];
+   mutable bool sortedValid;
+   void sortView() const;
+   int matchSorted(const IntSet& otherIntSet,
+                   bool* thisHit, bool* otherHit) const;
 };
 
 bool equal(const IntSet& is1, const IntSet& is2);
@@ -0,0 +1,191 @@
+// FILE: IntSetBench.cpp
+//       A benchmark of the basic operations of asg01's IntSet, writing
+//       the same machine-readable (CSV or JSON) records as asg02's
+//       IntSetBench.cpp (see there for the workload and the format), so
+//       the results of both can be tracked together.
+//
+// DESCRIPTION:
+// This IntSet holds at most MAX_SIZE values, and the union of the
+// workload's A and B has 1.5n of them, so it is measured at the one
+// size that fits, n = 2 * MAX_SIZE / 3 (6 for a MAX_SIZE of 10) rather
+// than at 10, 100, ... like the asg02 classes. The operations are so
+// short that each is timed in batches (doubling the batch until it
+// runs for MIN_SECONDS); remove is timed as a copy of A followed by the
+// removals, less the time of the copy alone.
+// Usage: ibench [csv|json]
+
+#include "IntSet.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sys/time.h>
+using namespace std;
+
+const double MIN_SECONDS = 0.02;
+
+enum Op { ADD, CONTAINS_HIT, CONTAINS_MISS, COPY, COPY_REMOVE,
+          UNION, INTERSECT, SUBTRACT, EQUAL };
+
+double seconds();
+// Post: The current time, in seconds since some fixed moment, is
+//       returned (with microsecond resolution).
+
+long runOp(Op op, int n, const int* values, const IntSet& a,
+           const IntSet& b, const IntSet& reversed);
+// Pre:  values holds the workload (A = [0, n), misses = [n, 2n)), and
+//       a, b and reversed were built from it.
+// Post: op has been run once, and a number depending on its result is
+//       returned (so that the work can't be optimized away).
+
+double nsPerCall(Op op, int n, const int* values, const IntSet& a,
+                 const IntSet& b, const IntSet& reversed, long& calls);
+// Pre:  As for runOp.
+// Post: op has been run in doubling batches until a batch took at least
+//       MIN_SECONDS; that batch's size is stored in calls and the
+//       average # of nanoseconds per call is returned.
+
+int main(int argc, char* argv[])
+{
+   bool json = ( argc > 1 && strcmp(argv[1], "json") == 0 );
+   if( argc > 1 && !json && strcmp(argv[1], "csv") != 0 )
+   {
+      cerr << "usage: ibench [csv|json]" << endl;
+      return EXIT_FAILURE;
+   }
+
+   const int n = 2 * IntSet::MAX_SIZE / 3;
+   int values[2 * IntSet::MAX_SIZE];
+   for( int i = 0; i < 2 * n; i ++ )
+      values[i] = i - n;
+   srand(3358);
+   for( int i = 2 * n - 1; i > 0; i -- )      // a random permutation
+   {
+      int j = rand() % ( i + 1 );
+      int t = values[i]; values[i] = values[j]; values[j] = t;
+   }
+
+   IntSet a;
+   IntSet b;
+   IntSet reversed;
+   for( int i = 0; i < n; i ++ )
+   {
+      a.add(values[i]);
+      b.add(values[n / 2 + i]);
+      reversed.add(values[n - 1 - i]);
+   }
+
+   const char* names[] = { "add", "contains_hit", "contains_miss", "",
+                           "remove", "union", "intersect", "subtract",
+                           "equal" };
+   long copyCalls = 0;
+   double copyNs = nsPerCall(COPY, n, values, a, b, reversed, copyCalls);
+
+   if( json )
+      cout << "{ \"format\": 1, \"benchmark\": \"IntSetBench\", \"results\": [";
+   else
+      cout << "impl,op,size,calls,elements_per_call,ns_per_call,ns_per_element\n";
+
+   bool first = true;
+   for( int op = ADD; op <= EQUAL; op ++ )
+   {
+      if( op == COPY )
+         continue;
+
+      long calls = 0;
+      double ns = nsPerCall(static_cast<Op>(op), n, values, a, b, reversed,
+                            calls);
+      if( op == COPY_REMOVE )
+         ns = ( ns > copyNs ) ? ns - copyNs : 0;
+
+      if( json )
+      {
+         cout << ( first ? "\n" : ",\n" )
+              << "  { \"impl\": \"asg01/IntSet\", \"op\": \"" << names[op]
+              << "\", \"size\": " << n << ", \"calls\": " << calls
+              << ", \"elements_per_call\": " << n
+              << ", \"ns_per_call\": " << ns
+              << ", \"ns_per_element\": " << ns / n << " }";
+      }
+      else
+      {
+         cout << "\"asg01/IntSet\"," << names[op] << ',' << n << ','
+              << calls << ',' << n << ',' << ns << ',' << ns / n << '\n';
+      }
+      first = false;
+   }
+
+   if( json )
+      cout << "\n] }\n";
+   return EXIT_SUCCESS;
+}
+
+double seconds()
+{
+   struct timeval tv;
+   gettimeofday(&tv, 0);
+   return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+long runOp(Op op, int n, const int* values, const IntSet& a,
+           const IntSet& b, const IntSet& reversed)
+{
+   long result = 0;
+   switch( op )
+   {
+      case ADD:
+      {
+         IntSet s;
+         for( int i = 0; i < n; i ++ )
+            s.add(values[i]);
+         result = s.size();
+         break;
+      }
+      case CONTAINS_HIT:
+      case CONTAINS_MISS:
+      {
+         const int* keys = ( op == CONTAINS_HIT ) ? values : values + n;
+         for( int i = 0; i < n; i ++ )
+            result += a.contains(keys[i]);
+         break;
+      }
+      case COPY:
+      case COPY_REMOVE:
+      {
+         IntSet s(a);
+         if( op == COPY_REMOVE )
+            for( int i = 0; i < n; i ++ )
+               s.remove(values[i]);
+         result = s.size();
+         break;
+      }
+      case UNION:
+         result = a.unionWith(b).size();
+         break;
+      case INTERSECT:
+         result = a.intersect(b).size();
+         break;
+      case SUBTRACT:
+         result = a.subtract(b).size();
+         break;
+      case EQUAL:
+         result = equal(a, reversed);
+         break;
+   }
+   return result;
+}
+
+double nsPerCall(Op op, int n, const int* values, const IntSet& a,
+                 const IntSet& b, const IntSet& reversed, long& calls)
+{
+   static volatile long sink = 0;      // (keeps the results "used")
+
+   for( calls = 1; ; calls *= 2 )
+   {
+      double start = seconds();
+      for( long c = 0; c < calls; c ++ )
+         sink += runOp(op, n, values, a, b, reversed);
+      double elapsed = seconds() - start;
+      if( elapsed >= MIN_SECONDS )
+         return elapsed * 1e9 / calls;
+   }
+}
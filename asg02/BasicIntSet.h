@@ -0,0 +1,281 @@
+// FILE: BasicIntSet.h - header file for BasicIntSet template class
+// TEMPLATE CLASSES PROVIDED:
+//                 template <class Key, class Rep = DefaultRep<Key>::type>
+//                 class BasicIntSet
+//                 (a container class for a set of integer keys of any
+//                 width, stored as the representation Rep says)
+//                 and the representations UnsortedRep<Key>,
+//                 SortedRep<Key>, HashRep<Key>, BitmapRep<Key> and
+//                 RunRep<Key>
+//
+// BasicIntSet has the set operations of IntSet for keys of any integer
+// type (e.g. int16_t codes, int32_t / uint32_t values or int64_t ids),
+// while the way the keys are stored is chosen at compile time by the
+// second template parameter (a "representation policy"):
+//   UnsortedRep<Key> - an array in membership order, searched by linear
+//                      scans (good for small sets)
+//   SortedRep<Key>   - an array in ascending order, searched by binary
+//                      search (compact, and cheap to build in order)
+//   HashRep<Key>     - an array in membership order plus a hash index,
+//                      like IntSet (good for large sets); as in IntSet,
+//                      remove closes up the array to keep membership
+//                      order, so it is O(n)
+//   BitmapRep<Key>   - one bit for every possible key; only for keys of
+//                      8 or 16 bits (2^16 bits = 8 KB at most), where it
+//                      is both the fastest and the densest
+//   RunRep<Key>      - sorted, disjoint [lo, hi] runs of consecutive
+//                      keys, searched by binary search, while the keys
+//                      are mostly in long runs (e.g. ranges of ids with
+//                      a few holes); it switches to (and back from) a
+//                      SortedRep-like array of the keys by itself as
+//                      the keys get more (or less) scattered
+// If Rep is left out, DefaultRep<Key>::type picks BitmapRep<Key> for
+// keys of up to 16 bits and HashRep<Key> for wider ones.
+//
+// Keys are stored at their own width, so narrow keys take less memory,
+// and the linear scans (UnsortedRep, and HashRep while small) compare
+// a whole 128-bit SSE2 vector of keys at a time: 16 8-bit keys, 8
+// 16-bit keys, 4 32-bit keys or 2 64-bit keys per instruction.
+//
+// The ORDER of the keys (as displayed by DumpData and visited by
+// forEach) is membership order for UnsortedRep and HashRep (as for
+// IntSet) and ascending order for SortedRep, BitmapRep and RunRep.
+//
+// TYPES
+//   typedef Key key_type
+//   typedef Rep rep_type
+//
+// CONSTRUCTOR
+//   BasicIntSet()
+//     Pre:  (none)
+//     Post: The invoking BasicIntSet is initialized to an empty set.
+//
+// CONSTANT MEMBER FUNCTIONS (ACCESSORS)
+//   int size() const
+//   bool isEmpty() const
+//   bool contains(Key aKey) const
+//   bool isSubsetOf(const BasicIntSet& otherSet) const
+//   void DumpData(std::ostream& out) const
+//   BasicIntSet unionWith(const BasicIntSet& otherSet) const
+//   BasicIntSet intersect(const BasicIntSet& otherSet) const
+//   BasicIntSet subtract(const BasicIntSet& otherSet) const
+//     Pre/Post: As for the IntSet functions of the same name (see
+//           IntSet.h), with keys in the ORDER described above (keys are
+//           displayed as numbers, even 8-bit ones).
+//   template <class Function>
+//   void forEach(Function visit) const
+//     Pre:  visit can be called as visit(Key).
+//     Post: visit has been called for each key, in ORDER.
+//
+// MODIFICATION MEMBER FUNCTIONS (MUTATORS)
+//   void reset()
+//   bool add(Key aKey)
+//   bool remove(Key aKey)
+//     Pre/Post: As for the IntSet functions of the same name.
+//
+// NON-MEMBER FUNCTIONS
+//   template <class Key, class Rep>
+//   bool operator==(const BasicIntSet<Key, Rep>& bs1,
+//                   const BasicIntSet<Key, Rep>& bs2)
+//     Pre:  (none)
+//     Post: True is returned if bs1 and bs2 have the same keys,
+//           otherwise false is returned.
+//
+// REPRESENTATION POLICY INTERFACE
+//   Each representation Rep (a class template over Key) provides:
+//     int size() const, bool contains(Key) const, bool insert(Key),
+//     bool erase(Key), void clear(), and
+//     template <class Function> void forEach(Function) const,
+//   with the meanings of size, contains, add, remove, reset and
+//   forEach above. A new representation only needs these to be used
+//   with BasicIntSet.
+//   unionWith, intersect and subtract call the function templates
+//     template <class Rep>
+//     void unionReps(const Rep& rep1, const Rep& rep2, Rep& result)
+//     (and intersectReps and subtractReps, with the same parameters),
+//   which store the union (etc.) of rep1 and rep2 in result (empty on
+//   entry) using only the functions above; a representation that can
+//   do better may overload them for itself (as RunRep does, sweeping
+//   the two lists of runs together in O(# of runs)).
+//
+// VALUE SEMANTICS
+//   Assignment, the copy constructor, move construction and move
+//   assignment may be used with BasicIntSet objects.
+
+#ifndef BASIC_INT_SET_H
+#define BASIC_INT_SET_H
+
+#include <iostream>
+#include <vector>
+#include <type_traits>
+
+template <class Key>
+int findKey(const Key* data, int n, Key key);
+// Pre:  data[0..n - 1] are valid (n >= 0).
+// Post: The lowest i such that data[i] == key is returned, or -1 if
+//       there is no such i (compared 16 / sizeof(Key) keys at a time).
+
+template <class Key>
+class UnsortedRep
+{
+public:
+   int size() const;
+   bool contains(Key aKey) const;
+   bool insert(Key aKey);
+   bool erase(Key aKey);
+   void clear();
+   template <class Function>
+   void forEach(Function visit) const;
+private:
+   std::vector<Key> keys;
+};
+
+template <class Key>
+class SortedRep
+{
+public:
+   int size() const;
+   bool contains(Key aKey) const;
+   bool insert(Key aKey);
+   bool erase(Key aKey);
+   void clear();
+   template <class Function>
+   void forEach(Function visit) const;
+private:
+   std::vector<Key> keys;
+};
+
+template <class Key>
+class HashRep
+{
+public:
+   int size() const;
+   bool contains(Key aKey) const;
+   bool insert(Key aKey);
+   bool erase(Key aKey);
+   void clear();
+   template <class Function>
+   void forEach(Function visit) const;
+private:
+   static const int INDEX_THRESHOLD = 16;
+   std::vector<Key> keys;
+   std::vector<int> slots;
+   int homeSlot(Key aKey) const;
+   int findSlot(Key aKey) const;
+   void rebuild();
+};
+
+template <class Key>
+class BitmapRep
+{
+public:
+   BitmapRep();
+   int size() const;
+   bool contains(Key aKey) const;
+   bool insert(Key aKey);
+   bool erase(Key aKey);
+   void clear();
+   template <class Function>
+   void forEach(Function visit) const;
+private:
+   static_assert(sizeof(Key) <= 2,
+                 "BitmapRep is only for keys of 8 or 16 bits");
+   static const int BITS = 1 << ( 8 * sizeof(Key) );
+   std::vector<unsigned long long> words;
+   int count;
+   static unsigned int bitOf(Key aKey);
+   static Key keyOf(unsigned int bit);
+};
+
+template <class Key>
+class RunRep
+{
+public:
+   RunRep();
+   int size() const;
+   bool contains(Key aKey) const;
+   bool insert(Key aKey);
+   bool erase(Key aKey);
+   void clear();
+   template <class Function>
+   void forEach(Function visit) const;
+   void unionOf(const RunRep& rep1, const RunRep& rep2);
+   void intersectionOf(const RunRep& rep1, const RunRep& rep2);
+   void differenceOf(const RunRep& rep1, const RunRep& rep2);
+private:
+   struct Run { Key lo, hi; };
+   static const int TO_RUNS = 4;
+   static const int TO_KEYS = 2;
+   std::vector<Key> keys;
+   std::vector<Run> runs;
+   bool inRuns;
+   int count;
+   int numRuns;
+   int findRun(Key aKey) const;
+   const std::vector<Run>& runView(std::vector<Run>& scratch) const;
+   void assignRuns(std::vector<Run>& newRuns);
+   void adapt();
+   static bool adjacent(Key lower, Key upper);
+   static int runLength(const Run& r);
+};
+
+template <class Key>
+struct DefaultRep
+{
+   typedef typename std::conditional< ( sizeof(Key) <= 2 ),
+                                      BitmapRep<Key>,
+                                      HashRep<Key> >::type type;
+};
+
+template <class Rep>
+void unionReps(const Rep& rep1, const Rep& rep2, Rep& result);
+template <class Rep>
+void intersectReps(const Rep& rep1, const Rep& rep2, Rep& result);
+template <class Rep>
+void subtractReps(const Rep& rep1, const Rep& rep2, Rep& result);
+// Pre:  result is empty.
+// Post: result holds the union / intersection / difference of the keys
+//       of rep1 and rep2 (see REPRESENTATION POLICY INTERFACE above).
+
+template <class Key>
+void unionReps(const RunRep<Key>& rep1, const RunRep<Key>& rep2,
+               RunRep<Key>& result);
+template <class Key>
+void intersectReps(const RunRep<Key>& rep1, const RunRep<Key>& rep2,
+                   RunRep<Key>& result);
+template <class Key>
+void subtractReps(const RunRep<Key>& rep1, const RunRep<Key>& rep2,
+                  RunRep<Key>& result);
+// Pre/Post: As above, by sweeping the runs of rep1 and rep2 together.
+
+template <class Key, class Rep = typename DefaultRep<Key>::type>
+class BasicIntSet
+{
+public:
+   static_assert(std::is_integral<Key>::value,
+                 "BasicIntSet keys must be of an integer type");
+   typedef Key key_type;
+   typedef Rep rep_type;
+   int size() const;
+   bool isEmpty() const;
+   bool contains(Key aKey) const;
+   bool isSubsetOf(const BasicIntSet& otherSet) const;
+   void DumpData(std::ostream& out) const;
+   BasicIntSet unionWith(const BasicIntSet& otherSet) const;
+   BasicIntSet intersect(const BasicIntSet& otherSet) const;
+   BasicIntSet subtract(const BasicIntSet& otherSet) const;
+   template <class Function>
+   void forEach(Function visit) const;
+   void reset();
+   bool add(Key aKey);
+   bool remove(Key aKey);
+private:
+   Rep rep;
+};
+
+template <class Key, class Rep>
+bool operator==(const BasicIntSet<Key, Rep>& bs1,
+                const BasicIntSet<Key, Rep>& bs2);
+
+#include "BasicIntSet.template"   // include the implementation
+#endif
@@ -0,0 +1,1045 @@
+// FILE: BitmapIntSet.cpp
+//       Implementation file for the BitmapIntSet class
+//       (See BitmapIntSet.h for documentation.)
+// INVARIANT for the BitmapIntSet class:
+// (1) Each int value v is split into a 16-bit "key" and a 16-bit
+//     "offset": with u = (unsigned) v ^ 0x80000000 (which maps the
+//     int values, in order, onto 0 .. 2^32 - 1), key = u >> 16 and
+//     offset = u & 0xFFFF. All values sharing a key form a chunk.
+// (2) The member variable chunks references a 1-D, dynamic array of
+//     chunkCapacity RoaringContainer's; chunks[0] through
+//     chunks[numChunks - 1] hold the non-empty chunks in ascending
+//     order of key (there is no container for an empty chunk), and
+//     we DON'T care what is in the rest of the array.
+// (3) A container holds the offsets of its chunk's values as one of:
+//     ARRAY  - shorts[0..n - 1] holds the offsets in ascending order
+//              (n == card <= ARRAY_MAX)
+//     BITMAP - bit (offset % 32) of words[offset / 32] is set for
+//              each offset (WORDS words of 32 bits)
+//     RUN    - shorts[2k] and shorts[2k + 1] hold the first offset
+//              and the length - 1 of run k (k = 0 .. n - 1), runs in
+//              ascending order and never touching one another
+//     and card is the # of values in the container.
+// (4) The member variable used is the total # of values (the sum of
+//     card over all containers).
+//
+// DOCUMENTATION for private member (helper) functions:
+//   int findChunk(int key) const
+//     Pre:  (none)
+//     Post: If there is a container for key, its index in chunks is
+//           returned, otherwise -(i + 1) is returned, where i is the
+//           index at which a container for key would be inserted.
+//   RoaringContainer& insertChunk(int at, int key)
+//     Pre:  0 <= at <= numChunks and key belongs at index at.
+//     Post: An empty ARRAY container for key has been inserted at
+//           index at (chunks grown if needed) and is returned.
+//   void eraseChunk(int at)
+//     Pre:  0 <= at < numChunks and chunks[at].card == 0
+//     Post: chunks[at] has been released and removed.
+//   void appendChunk(RoaringContainer& c)
+//     Pre:  c.key is greater than the key of every existing container.
+//     Post: If c is non-empty, the invoking BitmapIntSet has taken
+//           over c (and its memory) as its last container; otherwise
+//           c has been released.
+
+#include "BitmapIntSet.h"
+#include <iostream>
+using namespace std;
+
+struct RoaringContainer
+{
+   int key;                 // high 16 bits of the values held
+   int kind;                // ARRAY, BITMAP or RUN
+   int card;                // # of values held
+   int n;                   // ARRAY: # of offsets, RUN: # of runs
+   int cap;                 // # of shorts that shorts[] can hold
+   unsigned short* shorts;  // ARRAY offsets, or RUN (start, length - 1)
+   unsigned int* words;     // BITMAP bits
+};
+
+namespace
+{
+   enum { ARRAY, BITMAP, RUN };
+   const int ARRAY_MAX = 4096;   // an ARRAY this full is as big as a BITMAP
+   const int WORDS = 2048;       // 2^16 bits / 32 bits per word
+
+   // ======================================================================
+
+   void initContainer(RoaringContainer& c, int key)
+   {
+      c.key = key;
+      c.kind = ARRAY;
+      c.card = 0;
+      c.n = 0;
+      c.cap = 0;
+      c.shorts = 0;
+      c.words = 0;
+   }
+
+   // ======================================================================
+
+   void clearContainer(RoaringContainer& c)
+   {
+      delete [] c.shorts;
+      delete [] c.words;
+      initContainer(c, c.key);
+   }
+
+   // ======================================================================
+
+   void copyContainer(RoaringContainer& dst, const RoaringContainer& src)
+
+   // this function makes dst (assumed to own no memory) a deep copy of src
+   {
+      dst = src;
+      dst.shorts = 0;
+      dst.words = 0;
+      if( src.shorts )
+      {
+         dst.shorts = new unsigned short[src.cap];
+         int count = ( src.kind == RUN ) ? 2 * src.n : src.n;
+         for( int i = 0; i < count; i ++ )
+            dst.shorts[i] = src.shorts[i];
+      }
+      if( src.words )
+      {
+         dst.words = new unsigned int[WORDS];
+         for( int w = 0; w < WORDS; w ++ )
+            dst.words[w] = src.words[w];
+      }
+   }
+
+   // ======================================================================
+
+   void reserveShorts(RoaringContainer& c, int need)
+
+   // this function makes sure shorts[] can hold at least need entries,
+   // growing it geometrically
+   {
+      if( need <= c.cap )
+         return;
+
+      int new_cap = ( c.cap < 4 ) ? 4 : 2 * c.cap;
+      if( new_cap < need )
+         new_cap = need;
+
+      unsigned short* bigger = new unsigned short[new_cap];
+      int count = ( c.kind == RUN ) ? 2 * c.n : c.n;
+      for( int i = 0; i < count; i ++ )
+         bigger[i] = c.shorts[i];
+
+      delete [] c.shorts;
+      c.shorts = bigger;
+      c.cap = new_cap;
+   }
+
+   // ======================================================================
+
+   void setRange(unsigned int* w, int lo, int hi)
+
+   // this function sets bits lo through hi (inclusive) a word at a time
+   {
+      int first = lo >> 5;
+      int last = hi >> 5;
+      unsigned int loMask = ~0U << ( lo & 31 );
+      unsigned int hiMask = ~0U >> ( 31 - ( hi & 31 ) );
+
+      if( first == last )
+      {
+         w[first] |= ( loMask & hiMask );
+         return;
+      }
+      w[first] |= loMask;
+      for( int i = first + 1; i < last; i ++ )
+         w[i] = ~0U;
+      w[last] |= hiMask;
+   }
+
+   // ======================================================================
+
+   const unsigned int* wordsOf(const RoaringContainer& c, unsigned int* buf)
+
+   // this function returns the bitmap of c: c's own words if c is a
+   // BITMAP, otherwise buf after c's offsets have been set in it
+   {
+      if( c.kind == BITMAP )
+         return c.words;
+
+      for( int w = 0; w < WORDS; w ++ )
+         buf[w] = 0;
+
+      if( c.kind == ARRAY )
+      {
+         for( int i = 0; i < c.n; i ++ )
+            buf[c.shorts[i] >> 5] |= 1U << ( c.shorts[i] & 31 );
+      }
+      else
+      {
+         for( int r = 0; r < c.n; r ++ )
+            setRange(buf, c.shorts[2 * r], c.shorts[2 * r] + c.shorts[2 * r + 1]);
+      }
+      return buf;
+   }
+
+   // ======================================================================
+
+   void settleWords(RoaringContainer& c, const unsigned int* w)
+
+   // this function rebuilds c from the bitmap w (which may be c's own
+   // words) as whichever kind of container is smallest:
+   //    ARRAY 2 bytes/value, RUN 4 bytes/run, BITMAP 8192 bytes
+   {
+      int card = 0;
+      int runs = 0;
+      unsigned int carry = 0;          // top bit of the previous word
+      for( int i = 0; i < WORDS; i ++ )
+      {
+         card += __builtin_popcount(w[i]);
+         runs += __builtin_popcount(w[i] & ~( ( w[i] << 1 ) | carry ));
+         carry = w[i] >> 31;
+      }
+
+      int arrayBytes = ( card <= ARRAY_MAX ) ? 2 * card : 1 << 30;
+      int runBytes = 4 * runs;
+      int bitmapBytes = 4 * WORDS;
+
+      RoaringContainer r;
+      initContainer(r, c.key);
+      r.card = card;
+
+      if( arrayBytes <= runBytes && arrayBytes <= bitmapBytes )
+      {
+         r.kind = ARRAY;
+         reserveShorts(r, card);
+         for( int i = 0; i < WORDS; i ++ )
+         {
+            unsigned int bits = w[i];
+            while( bits != 0 )
+            {
+               r.shorts[r.n ++] = static_cast<unsigned short>(
+                                     32 * i + __builtin_ctz(bits) );
+               bits &= bits - 1;       // clear lowest set bit
+            }
+         }
+      }
+      else if( runBytes < bitmapBytes )
+      {
+         r.kind = RUN;
+         reserveShorts(r, 2 * runs);
+         int start = -1;
+         for( int bit = 0; bit <= 65536; bit ++ )
+         {
+            bool on = ( bit < 65536 ) && ( ( w[bit >> 5] >> ( bit & 31 ) ) & 1U );
+            if( on && start < 0 )
+               start = bit;
+            else if( !on && start >= 0 )
+            {
+               r.shorts[2 * r.n] = static_cast<unsigned short>(start);
+               r.shorts[2 * r.n + 1] = static_cast<unsigned short>(bit - 1 - start);
+               r.n ++;
+               start = -1;
+            }
+         }
+      }
+      else
+      {
+         r.kind = BITMAP;
+         r.words = new unsigned int[WORDS];
+         for( int i = 0; i < WORDS; i ++ )
+            r.words[i] = w[i];
+      }
+
+      clearContainer(c);               // (w is not used past this point)
+      c = r;
+   }
+
+   // ======================================================================
+
+   void settleArray(RoaringContainer& c)
+
+   // this function switches an ARRAY container to RUN if that's smaller
+   // (an ARRAY is never bigger than a BITMAP, so no need to check that)
+   {
+      if( c.kind != ARRAY || c.n == 0 )
+         return;
+
+      int runs = 1;
+      for( int i = 1; i < c.n; i ++ )
+         if( c.shorts[i] != c.shorts[i - 1] + 1 )
+            runs ++;
+
+      if( 4 * runs >= 2 * c.card )
+         return;
+
+      unsigned short* pairs = new unsigned short[2 * runs];
+      int r = 0;
+      int start = 0;
+      for( int i = 1; i <= c.n; i ++ )
+      {
+         if( i == c.n || c.shorts[i] != c.shorts[i - 1] + 1 )
+         {
+            pairs[2 * r] = c.shorts[start];
+            pairs[2 * r + 1] = static_cast<unsigned short>(i - 1 - start);
+            r ++;
+            start = i;
+         }
+      }
+
+      delete [] c.shorts;
+      c.shorts = pairs;
+      c.cap = 2 * runs;
+      c.n = runs;
+      c.kind = RUN;
+   }
+
+   // ======================================================================
+
+   void makeBitmap(RoaringContainer& c)
+
+   // this function converts c (of any kind) to a BITMAP in place
+   {
+      if( c.kind == BITMAP )
+         return;
+
+      unsigned int* w = new unsigned int[WORDS];
+      wordsOf(c, w);
+      delete [] c.shorts;
+      c.shorts = 0;
+      c.n = 0;
+      c.cap = 0;
+      c.words = w;
+      c.kind = BITMAP;
+   }
+
+   // ======================================================================
+
+   int lowerBound(const unsigned short* a, int n, int target)
+
+   // this function returns the first index of a[0..n - 1] whose entry
+   // is >= target (or n)
+   {
+      int lo = 0;
+      int hi = n;
+      while( lo < hi )
+      {
+         int mid = lo + ( hi - lo ) / 2;
+         if( a[mid] < target )
+            lo = mid + 1;
+         else
+            hi = mid;
+      }
+      return lo;
+   }
+
+   // ======================================================================
+
+   int runsBefore(const RoaringContainer& c, int low)
+
+   // this function returns the # of runs of RUN c that start at or
+   // before low (so run - 1 is the only one that can hold low)
+   {
+      int lo = 0;
+      int hi = c.n;
+      while( lo < hi )
+      {
+         int mid = lo + ( hi - lo ) / 2;
+         if( c.shorts[2 * mid] <= low )
+            lo = mid + 1;
+         else
+            hi = mid;
+      }
+      return lo;
+   }
+
+   // ======================================================================
+
+   bool containerContains(const RoaringContainer& c, int low)
+   {
+      if( c.kind == BITMAP )
+         return ( ( c.words[low >> 5] >> ( low & 31 ) ) & 1U ) != 0;
+
+      if( c.kind == ARRAY )
+      {
+         int i = lowerBound(c.shorts, c.n, low);
+         return ( i < c.n && c.shorts[i] == low );
+      }
+
+      int r = runsBefore(c, low);
+      return ( r > 0 && low <= c.shorts[2 * ( r - 1 )] + c.shorts[2 * ( r - 1 ) + 1] );
+   }
+
+   // ======================================================================
+
+   void openRun(RoaringContainer& c, int at, int start, int length)
+
+   // this function inserts the run [start, start + length] as run at of
+   // RUN c
+   {
+      reserveShorts(c, 2 * c.n + 2);
+      for( int k = 2 * c.n + 1; k > 2 * at + 1; k -- )
+         c.shorts[k] = c.shorts[k - 2];
+      c.shorts[2 * at] = static_cast<unsigned short>(start);
+      c.shorts[2 * at + 1] = static_cast<unsigned short>(length - 1);
+      c.n ++;
+   }
+
+   // ======================================================================
+
+   void closeRun(RoaringContainer& c, int at)
+
+   // this function removes run at of RUN c
+   {
+      for( int k = 2 * at; k < 2 * c.n - 2; k ++ )
+         c.shorts[k] = c.shorts[k + 2];
+      c.n --;
+   }
+
+   // ======================================================================
+
+   void settleRun(RoaringContainer& c)
+
+   // this function switches a RUN container that has just been edited
+   // to another kind if that is now smaller: ARRAY (2 bytes/value) once
+   // it has more runs than half its values, BITMAP (4 * WORDS bytes)
+   // once it has more than WORDS runs (4 bytes/run); an edit changes the
+   // run count by at most 1, so it stays a RUN until one of these is
+   // actually crossed
+   {
+      if( 2 * c.n > c.card && c.card <= ARRAY_MAX )
+      {
+         unsigned short* offsets = new unsigned short[c.card];
+         int count = 0;
+         for( int r = 0; r < c.n; r ++ )
+            for( int v = c.shorts[2 * r]; v <= c.shorts[2 * r] + c.shorts[2 * r + 1]; v ++ )
+               offsets[count ++] = static_cast<unsigned short>(v);
+         delete [] c.shorts;
+         c.shorts = offsets;
+         c.cap = c.card;
+         c.n = c.card;
+         c.kind = ARRAY;
+      }
+      else if( c.n > WORDS )
+         makeBitmap(c);
+   }
+
+   // ======================================================================
+
+   void makeArray(RoaringContainer& c)
+
+   // this function converts BITMAP c (with card <= ARRAY_MAX) to an
+   // ARRAY in place
+   {
+      c.shorts = new unsigned short[ARRAY_MAX];
+      c.cap = ARRAY_MAX;
+      c.n = 0;
+      for( int i = 0; i < WORDS; i ++ )
+      {
+         unsigned int bits = c.words[i];
+         while( bits != 0 )
+         {
+            c.shorts[c.n ++] = static_cast<unsigned short>(
+                                  32 * i + __builtin_ctz(bits) );
+            bits &= bits - 1;       // clear lowest set bit
+         }
+      }
+      delete [] c.words;
+      c.words = 0;
+      c.kind = ARRAY;
+   }
+
+   // ======================================================================
+
+   bool runAdd(RoaringContainer& c, int low)
+
+   // this function adds low (not in RUN c) by growing the run just
+   // before or just after it (joining them if it closes the gap between
+   // them), or else by opening a run of its own
+   {
+      int r = runsBefore(c, low);
+      bool joinsPrev = ( r > 0
+                         && c.shorts[2 * ( r - 1 )] + c.shorts[2 * ( r - 1 ) + 1] + 1 == low );
+      bool joinsNext = ( r < c.n && c.shorts[2 * r] == low + 1 );
+
+      if( joinsPrev && joinsNext )
+      {
+         c.shorts[2 * ( r - 1 ) + 1] = static_cast<unsigned short>(
+            c.shorts[2 * r] + c.shorts[2 * r + 1] - c.shorts[2 * ( r - 1 )] );
+         closeRun(c, r);
+      }
+      else if( joinsPrev )
+         c.shorts[2 * ( r - 1 ) + 1] ++;
+      else if( joinsNext )
+      {
+         c.shorts[2 * r] --;
+         c.shorts[2 * r + 1] ++;
+      }
+      else
+         openRun(c, r, low, 1);
+      c.card ++;
+      settleRun(c);
+      return true;
+   }
+
+   // ======================================================================
+
+   bool runRemove(RoaringContainer& c, int low)
+
+   // this function removes low (in RUN c) by shrinking its run from
+   // either end, dropping it if low was all of it, or splitting it in 2
+   {
+      int r = runsBefore(c, low) - 1;
+      int start = c.shorts[2 * r];
+      int end = start + c.shorts[2 * r + 1];
+
+      if( start == end )
+         closeRun(c, r);
+      else if( low == start )
+      {
+         c.shorts[2 * r] ++;
+         c.shorts[2 * r + 1] --;
+      }
+      else if( low == end )
+         c.shorts[2 * r + 1] --;
+      else
+      {
+         c.shorts[2 * r + 1] = static_cast<unsigned short>(low - 1 - start);
+         openRun(c, r + 1, low + 1, end - low);
+      }
+      c.card --;
+      settleRun(c);
+      return true;
+   }
+
+   // ======================================================================
+
+   bool containerAdd(RoaringContainer& c, int low)
+   {
+      if( containerContains(c, low) )
+         return false;
+
+      if( c.kind == RUN )
+         return runAdd(c, low);
+
+      if( c.kind == ARRAY && c.n == ARRAY_MAX )
+         makeBitmap(c);                // array is full: switch to bitmap
+
+      if( c.kind == BITMAP )
+         c.words[low >> 5] |= 1U << ( low & 31 );
+      else
+      {
+         reserveShorts(c, c.n + 1);
+         int i = lowerBound(c.shorts, c.n, low);
+         for( int k = c.n; k > i; k -- )
+            c.shorts[k] = c.shorts[k - 1];
+         c.shorts[i] = static_cast<unsigned short>(low);
+         c.n ++;
+      }
+      c.card ++;
+      return true;
+   }
+
+   // ======================================================================
+
+   bool containerRemove(RoaringContainer& c, int low)
+   {
+      if( !containerContains(c, low) )
+         return false;
+
+      if( c.kind == RUN )
+         return runRemove(c, low);
+
+      c.card --;
+      if( c.kind == BITMAP )
+      {
+         c.words[low >> 5] &= ~( 1U << ( low & 31 ) );
+         if( c.card == ARRAY_MAX )     // just small enough for an array
+            makeArray(c);
+      }
+      else
+      {
+         int i = lowerBound(c.shorts, c.n, low);
+         for( int k = i; k < c.n - 1; k ++ )
+            c.shorts[k] = c.shorts[k + 1];
+         c.n --;
+      }
+      return true;
+   }
+
+   // ======================================================================
+
+   void filterArray(const RoaringContainer& a, const RoaringContainer& b,
+                    bool keepCommon, RoaringContainer& r)
+
+   // this function puts into r (an empty ARRAY) the offsets of ARRAY a
+   // that are (keepCommon) or are not (!keepCommon) in b
+   {
+      reserveShorts(r, a.n);
+      for( int i = 0; i < a.n; i ++ )
+      {
+         if( containerContains(b, a.shorts[i]) == keepCommon )
+            r.shorts[r.n ++] = a.shorts[i];
+      }
+      r.card = r.n;
+      settleArray(r);
+   }
+}
+
+// ==========================================================================
+
+int BitmapIntSet::findChunk(int key) const
+
+// this function binary searches chunks[] by key
+{
+   int lo = 0;
+   int hi = numChunks;
+   while( lo < hi )
+   {
+      int mid = lo + ( hi - lo ) / 2;
+      if( chunks[mid].key < key )
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   if( lo < numChunks && chunks[lo].key == key )
+      return lo;
+   return -( lo + 1 );
+}
+
+// ==========================================================================
+
+RoaringContainer& BitmapIntSet::insertChunk(int at, int key)
+
+// this function opens a hole at chunks[at] (the containers themselves
+// are just moved over; they keep their memory) and fills it
+{
+   if( numChunks == chunkCapacity )
+   {
+      chunkCapacity = ( chunkCapacity < 4 ) ? 4 : 2 * chunkCapacity;
+      RoaringContainer* bigger = new RoaringContainer[chunkCapacity];
+      for( int i = 0; i < numChunks; i ++ )
+         bigger[i] = chunks[i];
+      delete [] chunks;
+      chunks = bigger;
+   }
+
+   for( int i = numChunks; i > at; i -- )
+      chunks[i] = chunks[i - 1];
+   numChunks ++;
+
+   initContainer(chunks[at], key);
+   return chunks[at];
+}
+
+// ==========================================================================
+
+void BitmapIntSet::eraseChunk(int at)
+{
+   clearContainer(chunks[at]);
+   for( int i = at; i < numChunks - 1; i ++ )
+      chunks[i] = chunks[i + 1];
+   numChunks --;
+}
+
+// ==========================================================================
+
+void BitmapIntSet::appendChunk(RoaringContainer& c)
+{
+   if( c.card == 0 )
+   {
+      clearContainer(c);
+      return;
+   }
+   RoaringContainer& last = insertChunk(numChunks, c.key);
+   last = c;                        // take over c's memory
+   used += c.card;
+}
+
+// ==========================================================================
+
+BitmapIntSet::BitmapIntSet()
+: chunks(0), numChunks(0), chunkCapacity(0), used(0)
+{
+}
+
+// ==========================================================================
+
+BitmapIntSet::BitmapIntSet(const BitmapIntSet& src)
+: chunks(0), numChunks(0), chunkCapacity(0), used(0)
+{
+   *this = src;
+}
+
+// ==========================================================================
+
+BitmapIntSet::~BitmapIntSet()
+{
+   reset();
+   delete [] chunks;
+}
+
+// ==========================================================================
+
+BitmapIntSet& BitmapIntSet::operator=(const BitmapIntSet& rhs)
+{
+   if( this == &rhs )
+      return *this;
+
+   reset();
+   for( int i = 0; i < rhs.numChunks; i ++ )
+   {
+      RoaringContainer c;
+      copyContainer(c, rhs.chunks[i]);
+      appendChunk(c);
+   }
+   return *this;
+}
+
+// ==========================================================================
+
+int BitmapIntSet::size() const
+{
+   return used;
+}
+
+// ==========================================================================
+
+bool BitmapIntSet::isEmpty() const
+{
+   return ( used == 0 );
+}
+
+// ==========================================================================
+
+bool BitmapIntSet::contains(int anInt) const
+{
+   unsigned int u = static_cast<unsigned int>(anInt) ^ 0x80000000U;
+   int at = findChunk(static_cast<int>(u >> 16));
+
+   return ( at >= 0 && containerContains(chunks[at], u & 0xFFFF) );
+}
+
+// ==========================================================================
+
+bool BitmapIntSet::isSubsetOf(const BitmapIntSet& otherSet) const
+
+// this function checks every container against the container for the
+// same key in otherSet: an ARRAY offset by offset, anything else a word
+// at a time (no bit may be set here that isn't set there)
+{
+   if( used > otherSet.used )
+      return false;
+
+   unsigned int bufA[WORDS];
+   unsigned int bufB[WORDS];
+   int j = 0;
+
+   for( int i = 0; i < numChunks; i ++ )
+   {
+      const RoaringContainer& a = chunks[i];
+      while( j < otherSet.numChunks && otherSet.chunks[j].key < a.key )
+         j ++;
+      if( j == otherSet.numChunks || otherSet.chunks[j].key != a.key )
+         return false;
+
+      const RoaringContainer& b = otherSet.chunks[j];
+      if( a.card > b.card )
+         return false;
+
+      if( a.kind == ARRAY )
+      {
+         for( int k = 0; k < a.n; k ++ )
+            if( !containerContains(b, a.shorts[k]) )
+               return false;
+      }
+      else
+      {
+         const unsigned int* wa = wordsOf(a, bufA);
+         const unsigned int* wb = wordsOf(b, bufB);
+         for( int w = 0; w < WORDS; w ++ )
+            if( wa[w] & ~wb[w] )
+               return false;
+      }
+   }
+   return true;
+}
+
+// ==========================================================================
+
+void BitmapIntSet::DumpData(ostream& out) const
+
+// this function displays the values in ascending order, in the same
+// format as IntSet::DumpData
+{
+   bool first = true;
+
+   for( int i = 0; i < numChunks; i ++ )
+   {
+      const RoaringContainer& c = chunks[i];
+      unsigned int base = static_cast<unsigned int>(c.key) << 16;
+
+      if( c.kind == ARRAY )
+      {
+         for( int k = 0; k < c.n; k ++ )
+         {
+            out << ( first ? "" : "  " )
+                << static_cast<int>( ( base | c.shorts[k] ) ^ 0x80000000U );
+            first = false;
+         }
+      }
+      else if( c.kind == RUN )
+      {
+         for( int r = 0; r < c.n; r ++ )
+         {
+            int last = c.shorts[2 * r] + c.shorts[2 * r + 1];
+            for( int low = c.shorts[2 * r]; low <= last; low ++ )
+            {
+               out << ( first ? "" : "  " )
+                   << static_cast<int>( ( base | low ) ^ 0x80000000U );
+               first = false;
+            }
+         }
+      }
+      else
+      {
+         for( int w = 0; w < WORDS; w ++ )
+         {
+            unsigned int bits = c.words[w];
+            while( bits != 0 )
+            {
+               unsigned int low = 32 * w + __builtin_ctz(bits);
+               out << ( first ? "" : "  " )
+                   << static_cast<int>( ( base | low ) ^ 0x80000000U );
+               first = false;
+               bits &= bits - 1;
+            }
+         }
+      }
+   }
+}
+
+// ==========================================================================
+
+BitmapIntSet BitmapIntSet::unionWith(const BitmapIntSet& otherSet) const
+
+// this function merges the two lists of containers by key; a container
+// with no partner is copied, and partners are combined (two ARRAY's by
+// merging them, anything else by OR-ing the bitmaps a word at a time)
+{
+   BitmapIntSet result;
+   unsigned int bufA[WORDS];
+   unsigned int bufB[WORDS];
+   int i = 0;
+   int j = 0;
+
+   while( i < numChunks || j < otherSet.numChunks )
+   {
+      RoaringContainer r;
+
+      if( j == otherSet.numChunks ||
+          ( i < numChunks && chunks[i].key < otherSet.chunks[j].key ) )
+      {
+         copyContainer(r, chunks[i ++]);
+      }
+      else if( i == numChunks || otherSet.chunks[j].key < chunks[i].key )
+      {
+         copyContainer(r, otherSet.chunks[j ++]);
+      }
+      else
+      {
+         const RoaringContainer& a = chunks[i ++];
+         const RoaringContainer& b = otherSet.chunks[j ++];
+         initContainer(r, a.key);
+
+         if( a.kind == ARRAY && b.kind == ARRAY &&
+             a.n + b.n <= ARRAY_MAX )
+         {
+            reserveShorts(r, a.n + b.n);
+            int p = 0;
+            int q = 0;
+            while( p < a.n || q < b.n )
+            {
+               if( q == b.n || ( p < a.n && a.shorts[p] < b.shorts[q] ) )
+                  r.shorts[r.n ++] = a.shorts[p ++];
+               else if( p == a.n || b.shorts[q] < a.shorts[p] )
+                  r.shorts[r.n ++] = b.shorts[q ++];
+               else
+               {
+                  r.shorts[r.n ++] = a.shorts[p ++];
+                  q ++;
+               }
+            }
+            r.card = r.n;
+            settleArray(r);
+         }
+         else
+         {
+            const unsigned int* wa = wordsOf(a, bufA);
+            const unsigned int* wb = wordsOf(b, bufB);
+            unsigned int out[WORDS];
+            for( int w = 0; w < WORDS; w ++ )
+               out[w] = wa[w] | wb[w];
+            settleWords(r, out);
+         }
+      }
+
+      result.appendChunk(r);
+   }
+
+   return result;
+}
+
+// ==========================================================================
+
+BitmapIntSet BitmapIntSet::intersect(const BitmapIntSet& otherSet) const
+
+// this function combines only the containers whose key is in both sets;
+// if either partner is an ARRAY its offsets are just filtered through
+// the other container, otherwise the bitmaps are AND-ed word by word
+{
+   BitmapIntSet result;
+   unsigned int bufA[WORDS];
+   unsigned int bufB[WORDS];
+   int i = 0;
+   int j = 0;
+
+   while( i < numChunks && j < otherSet.numChunks )
+   {
+      if( chunks[i].key < otherSet.chunks[j].key )
+         i ++;
+      else if( otherSet.chunks[j].key < chunks[i].key )
+         j ++;
+      else
+      {
+         const RoaringContainer& a = chunks[i ++];
+         const RoaringContainer& b = otherSet.chunks[j ++];
+         RoaringContainer r;
+         initContainer(r, a.key);
+
+         if( a.kind == ARRAY )
+            filterArray(a, b, true, r);
+         else if( b.kind == ARRAY )
+            filterArray(b, a, true, r);
+         else
+         {
+            const unsigned int* wa = wordsOf(a, bufA);
+            const unsigned int* wb = wordsOf(b, bufB);
+            unsigned int out[WORDS];
+            for( int w = 0; w < WORDS; w ++ )
+               out[w] = wa[w] & wb[w];
+            settleWords(r, out);
+         }
+
+         result.appendChunk(r);
+      }
+   }
+
+   return result;
+}
+
+// ==========================================================================
+
+BitmapIntSet BitmapIntSet::subtract(const BitmapIntSet& otherSet) const
+
+// this function copies each container that has no partner in otherSet
+// and otherwise removes the partner's values: by filtering if this
+// side is an ARRAY, else by AND-ing with the complement word by word
+{
+   BitmapIntSet result;
+   unsigned int bufA[WORDS];
+   unsigned int bufB[WORDS];
+   int j = 0;
+
+   for( int i = 0; i < numChunks; i ++ )
+   {
+      const RoaringContainer& a = chunks[i];
+      RoaringContainer r;
+
+      while( j < otherSet.numChunks && otherSet.chunks[j].key < a.key )
+         j ++;
+
+      if( j == otherSet.numChunks || otherSet.chunks[j].key != a.key )
+         copyContainer(r, a);
+      else
+      {
+         const RoaringContainer& b = otherSet.chunks[j];
+         initContainer(r, a.key);
+
+         if( a.kind == ARRAY )
+            filterArray(a, b, false, r);
+         else
+         {
+            const unsigned int* wa = wordsOf(a, bufA);
+            const unsigned int* wb = wordsOf(b, bufB);
+            unsigned int out[WORDS];
+            for( int w = 0; w < WORDS; w ++ )
+               out[w] = wa[w] & ~wb[w];
+            settleWords(r, out);
+         }
+      }
+
+      result.appendChunk(r);
+   }
+
+   return result;
+}
+
+// ==========================================================================
+
+void BitmapIntSet::reset()
+{
+   for( int i = 0; i < numChunks; i ++ )
+      clearContainer(chunks[i]);
+   numChunks = 0;
+   used = 0;
+}
+
+// ==========================================================================
+
+bool BitmapIntSet::add(int anInt)
+{
+   unsigned int u = static_cast<unsigned int>(anInt) ^ 0x80000000U;
+   int key = static_cast<int>(u >> 16);
+   int at = findChunk(key);
+
+   RoaringContainer& c = ( at >= 0 ) ? chunks[at] : insertChunk(-at - 1, key);
+   if( !containerAdd(c, u & 0xFFFF) )
+      return false;
+
+   used ++;
+   return true;
+}
+
+// ==========================================================================
+
+bool BitmapIntSet::remove(int anInt)
+{
+   unsigned int u = static_cast<unsigned int>(anInt) ^ 0x80000000U;
+   int at = findChunk(static_cast<int>(u >> 16));
+
+   if( at < 0 || !containerRemove(chunks[at], u & 0xFFFF) )
+      return false;
+
+   if( chunks[at].card == 0 )      // no containers for empty chunks
+      eraseChunk(at);
+   used --;
+   return true;
+}
+
+// ==========================================================================
+
+void BitmapIntSet::runOptimize()
+{
+   unsigned int buf[WORDS];
+   for( int i = 0; i < numChunks; i ++ )
+      settleWords(chunks[i], wordsOf(chunks[i], buf));
+}
+
+// ==========================================================================
+
+bool operator==(const BitmapIntSet& bs1, const BitmapIntSet& bs2)
+
+// this function checks that the sets are the same size and that one is
+// a subset of the other (which, for equal sizes, means they are equal)
+{
+   return ( bs1.size() == bs2.size() && bs1.isSubsetOf(bs2) );
+}
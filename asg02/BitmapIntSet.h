@@ -0,0 +1,144 @@
+// FILE: BitmapIntSet.h - header file for BitmapIntSet class
+// CLASS PROVIDED: BitmapIntSet (a container class for a set of
+//                 int values, stored as compressed bitmaps)
+//
+// BitmapIntSet offers the same operations as IntSet (see IntSet.h),
+// but instead of one array of ints it splits the range of int values
+// into chunks of 2^16 consecutive values and stores the members of
+// each chunk in a "container" of whichever kind is smallest for them:
+//   ARRAY  - a sorted array of 16-bit offsets (sparse chunks, up to
+//            4096 members)
+//   BITMAP - a 2^16-bit bitmap (dense chunks)
+//   RUN    - a sorted array of [start, start + length] runs of
+//            offsets (chunks made of a few long ranges)
+// so that dense ranges of values cost about one bit each, and the set
+// operations can work on 32 values per machine word.
+//
+// IMPORTANT: A BitmapIntSet keeps no record of membership order; its
+//            values are always kept (and displayed) in ascending order.
+//
+// CONSTRUCTOR
+//   BitmapIntSet()
+//     Pre:  (none)
+//     Post: The invoking BitmapIntSet is initialized to an empty
+//           BitmapIntSet.
+//
+// CONSTANT MEMBER FUNCTIONS (ACCESSORS)
+//   int size() const
+//     Pre:  (none)
+//     Post: Number of elements in the invoking BitmapIntSet is
+//           returned.
+//   bool isEmpty() const
+//     Pre:  (none)
+//     Post: True is returned if the invoking BitmapIntSet has no
+//           elements, otherwise false is returned.
+//   bool contains(int anInt) const
+//     Pre:  (none)
+//     Post: true is returned if the invoking BitmapIntSet has anInt
+//           as an element, otherwise false is returned.
+//   bool isSubsetOf(const BitmapIntSet& otherSet) const
+//     Pre:  (none)
+//     Post: True is returned if all elements of the invoking
+//           BitmapIntSet are also elements of otherSet, otherwise
+//           false is returned (an empty BitmapIntSet is a subset of
+//           any BitmapIntSet).
+//   void DumpData(std::ostream& out) const
+//     Pre:  (none)
+//     Post: Contents of the invoking BitmapIntSet have been inserted
+//           into out, in ascending order, with 2 spaces separating
+//           one item from another if there are 2 or more items.
+//   BitmapIntSet unionWith(const BitmapIntSet& otherSet) const
+//     Pre:  (none)
+//     Post: A BitmapIntSet representing the union of the invoking
+//           BitmapIntSet and otherSet is returned.
+//   BitmapIntSet intersect(const BitmapIntSet& otherSet) const
+//     Pre:  (none)
+//     Post: A BitmapIntSet representing the intersection of the
+//           invoking BitmapIntSet and otherSet is returned.
+//   BitmapIntSet subtract(const BitmapIntSet& otherSet) const
+//     Pre:  (none)
+//     Post: A BitmapIntSet representing the difference between the
+//           invoking BitmapIntSet and otherSet is returned.
+//     Note: Where the 3 set operations above combine two containers
+//           (one from each operand), the resulting container is of
+//           its smallest kind (as by runOptimize); containers copied
+//           over from just one operand keep their kind.
+//
+// MODIFICATION MEMBER FUNCTIONS (MUTATORS)
+//   void reset()
+//     Pre:  (none)
+//     Post: The invoking BitmapIntSet is reset to become an empty
+//           BitmapIntSet.
+//   bool add(int anInt)
+//     Pre:  (none)
+//     Post: If contains(anInt) returns false, anInt has been added
+//           to the invoking BitmapIntSet and true is returned,
+//           otherwise the invoking BitmapIntSet is unchanged and
+//           false is returned.
+//   bool remove(int anInt)
+//     Pre:  (none)
+//     Post: If contains(anInt) returns true, anInt has been removed
+//           from the invoking BitmapIntSet and true is returned,
+//           otherwise the invoking BitmapIntSet is unchanged and
+//           false is returned.
+//     Note: add and remove switch a container between ARRAY and
+//           BITMAP as it crosses 4096 members; they edit a RUN
+//           container's runs in place (growing, shrinking, joining or
+//           splitting one), and switch it to ARRAY or BITMAP only when
+//           its # of runs makes that kind smaller.
+//   void runOptimize()
+//     Pre:  (none)
+//     Post: Every container has been switched to whichever of the 3
+//           kinds takes the least memory for its current members.
+//
+// NON-MEMBER FUNCTIONS
+//   bool operator==(const BitmapIntSet& bs1, const BitmapIntSet& bs2)
+//     Pre:  (none)
+//     Post: True is returned if bs1 and bs2 have the same elements,
+//           otherwise false is returned.
+//
+// VALUE SEMANTICS
+//   Assignment and the copy constructor may be used with BitmapIntSet
+//   objects.
+
+#ifndef BITMAP_INT_SET_H
+#define BITMAP_INT_SET_H
+
+#include <iostream>
+
+struct RoaringContainer;   // one chunk of 2^16 values (see .cpp)
+
+class BitmapIntSet
+{
+public:
+   BitmapIntSet();
+   BitmapIntSet(const BitmapIntSet& src);
+   ~BitmapIntSet();
+   BitmapIntSet& operator=(const BitmapIntSet& rhs);
+   int size() const;
+   bool isEmpty() const;
+   bool contains(int anInt) const;
+   bool isSubsetOf(const BitmapIntSet& otherSet) const;
+   void DumpData(std::ostream& out) const;
+   BitmapIntSet unionWith(const BitmapIntSet& otherSet) const;
+   BitmapIntSet intersect(const BitmapIntSet& otherSet) const;
+   BitmapIntSet subtract(const BitmapIntSet& otherSet) const;
+   void reset();
+   bool add(int anInt);
+   bool remove(int anInt);
+   void runOptimize();
+
+private:
+   RoaringContainer* chunks;
+   int numChunks;
+   int chunkCapacity;
+   int used;
+   int  findChunk(int key) const;
+   RoaringContainer& insertChunk(int at, int key);
+   void eraseChunk(int at);
+   void appendChunk(RoaringContainer& c);
+};
+
+bool operator==(const BitmapIntSet& bs1, const BitmapIntSet& bs2);
+
+#endif
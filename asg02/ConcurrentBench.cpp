@@ -0,0 +1,146 @@
+// FILE: ConcurrentBench.cpp
+//       A benchmark of contains() throughput on a large set shared by a
+//       growing number of reader threads while one writer thread keeps
+//       adding and removing values, comparing a ConcurrentIntSet with
+//       an IntSet guarded by a single mutex.
+//
+// DESCRIPTION:
+// The set holds SET_SIZE random values. For each thread count, the
+// readers look up random values (about half of them members) for
+// RUN_MS milliseconds while the writer adds a new value and removes it
+// again every WRITE_MS milliseconds. The total # of lookups per second
+// (in millions) and the # of changes the writer made are printed to
+// cout for both versions. Usage: cbench [max_threads]
+
+#include "ConcurrentIntSet.h"
+#include "IntSet.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+const int SET_SIZE = 1000000;
+const int KEY_RANGE = 2 * SET_SIZE;
+const int RUN_MS = 500;
+const int WRITE_MS = 5;
+
+struct LockedIntSet                   // the "global mutex" way
+{
+   IntSet set;
+   mutable mutex lock;
+   bool contains(int anInt) const
+      { lock_guard<mutex> guard(lock); return set.contains(anInt); }
+   void add(int anInt)
+      { lock_guard<mutex> guard(lock); set.add(anInt); }
+   void remove(int anInt)
+      { lock_guard<mutex> guard(lock); set.remove(anInt); }
+};
+
+template <class SharedSet>
+double run(SharedSet& shared, int numReaders, long& changes);
+// Pre:  numReaders >= 1
+// Post: numReaders readers and one writer have used shared for RUN_MS
+//       milliseconds; the # of lookups per second (in millions) is
+//       returned and the # of writer changes is stored in changes.
+
+int main(int argc, char* argv[])
+{
+   int maxThreads = ( argc > 1 ) ? atoi(argv[1])
+                                 : static_cast<int>(thread::hardware_concurrency());
+   if( maxThreads < 1 )
+      maxThreads = 1;
+
+   srand(3358);
+   vector<int> values(SET_SIZE);
+   for( int i = 0; i < SET_SIZE; i ++ )
+      values[i] = rand() % KEY_RANGE;
+
+   IntSet initial;
+   initial.addAll(values.begin(), values.end());
+
+   ConcurrentIntSet concurrent(initial);
+   LockedIntSet locked;
+   locked.set = initial;
+
+   cout << "set size " << initial.size() << ", "
+        << thread::hardware_concurrency() << " hardware threads" << endl;
+   cout << setw(8) << "readers" << setw(16) << "mutex Mops/s"
+        << setw(10) << "writes" << setw(16) << "snapshot Mops/s"
+        << setw(10) << "writes" << setw(10) << "speedup" << endl;
+
+   for( int t = 1; t <= maxThreads; t *= 2 )
+   {
+      long lockedChanges = 0;
+      long concurrentChanges = 0;
+      double lockedRate = run(locked, t, lockedChanges);
+      double concurrentRate = run(concurrent, t, concurrentChanges);
+
+      cout << setw(8) << t << fixed << setprecision(2)
+           << setw(16) << lockedRate << setw(10) << lockedChanges
+           << setw(16) << concurrentRate << setw(10) << concurrentChanges
+           << setw(9) << concurrentRate / lockedRate << "x" << endl;
+   }
+
+   return EXIT_SUCCESS;
+}
+
+template <class SharedSet>
+double run(SharedSet& shared, int numReaders, long& changes)
+{
+   atomic<bool> stop(false);
+   atomic<long> lookups(0);
+   atomic<long> hits(0);
+   vector<thread> readers;
+
+   for( int r = 0; r < numReaders; r ++ )
+   {
+      readers.push_back(thread([&shared, &stop, &lookups, &hits, r]()
+      {
+         unsigned int x = 2463534242U + r;        // xorshift keys
+         long count = 0;
+         long found = 0;
+         while( !stop.load(memory_order_relaxed) )
+         {
+            for( int k = 0; k < 256; k ++ )
+            {
+               x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+               found += shared.contains(static_cast<int>(x % KEY_RANGE));
+            }
+            count += 256;
+         }
+         lookups += count;
+         hits += found;
+      }));
+   }
+
+   thread writer([&shared, &stop, &changes]()
+   {
+      int next = KEY_RANGE;                      // never a member yet
+      while( !stop.load() )
+      {
+         shared.add(next);
+         shared.remove(next);
+         next ++;
+         changes += 2;
+         this_thread::sleep_for(chrono::milliseconds(WRITE_MS));
+      }
+   });
+
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   this_thread::sleep_for(chrono::milliseconds(RUN_MS));
+   stop = true;
+   for( size_t r = 0; r < readers.size(); r ++ )
+      readers[r].join();
+   writer.join();
+   double seconds = chrono::duration<double>(chrono::steady_clock::now()
+                                             - start).count();
+
+   if( hits.load() == 0 )                        // (keeps lookups alive)
+      cout << "no hits?" << endl;
+   return lookups.load() / seconds / 1e6;
+}
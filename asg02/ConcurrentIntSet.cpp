@@ -0,0 +1,313 @@
+// FILE: ConcurrentIntSet.cpp
+//       Implementation file for the ConcurrentIntSet class
+//       (See ConcurrentIntSet.h for documentation.)
+// INVARIANT for the ConcurrentIntSet class:
+// (1) The member variable current references the current snapshot: a
+//     dynamically allocated IntSet that is never changed once it has
+//     been published (so readers need no lock to use it).
+// (2) Readers announce themselves in the reader counts of stripes: a
+//     reader adds 1 to stripes[s].readers[g % 2] for the value g of
+//     the member variable generation that it saw (s is fixed per
+//     thread, so readers on different threads don't share a counter's
+//     cache line), and takes 1 off when done with the snapshot.
+// (3) A writer (holding writeLock) publishes a new snapshot by swapping
+//     it into current, and puts the old one in the member variable
+//     retired, with the value of generation at the swap. Generation
+//     goes from g to g + 1 only when no reader is counted under the
+//     parity of g + 1 (i.e., of g - 1), so a count under a parity never
+//     mixes readers of two different generations, and every reader
+//     counted is of the current generation or the one before. A reader
+//     of generation g + 1 or later picks up a snapshot published after
+//     every swap made at g (a reader that saw generation change while
+//     announcing itself backs out and tries again), so once generation
+//     reaches g + 2 the snapshots retired at g (or before) are no
+//     longer in use by any reader, and are released.
+//
+// DOCUMENTATION for private member (helper) functions:
+//   static int stripeIndex()
+//     Pre:  (none)
+//     Post: The index of the calling thread's stripe is returned.
+//   std::atomic<long>* enterRead(const IntSet*& set) const
+//     Pre:  (none)
+//     Post: The calling thread is counted as a reader (see invariant
+//           2), set references the snapshot it may use, and the count
+//           to take 1 off when done is returned.
+//   bool drained(unsigned long parity) const
+//     Pre:  parity is 0 or 1.
+//     Post: True is returned if no reader was counted under parity
+//           when its stripe was looked at.
+//   void publish(IntSet* next)
+//     Pre:  The calling thread holds writeLock; next is a dynamically
+//           allocated IntSet that no one else references.
+//     Post: next is the current snapshot and the old one has been
+//           retired; generation has been moved on as far as the
+//           readers allow (by 2 at most), and the retired snapshots no
+//           longer in use by any reader have been released. Never
+//           waits for readers.
+
+#include "ConcurrentIntSet.h"
+using namespace std;
+
+// ========================================================================
+
+int ConcurrentIntSet::stripeIndex()
+
+// this function gives each thread a stripe of its own, in the order the
+// threads first read (wrapping around after NUM_STRIPES threads)
+{
+   static atomic<int> nextStripe(0);
+   thread_local int myStripe = -1;
+
+   if( myStripe < 0 )
+      myStripe = nextStripe.fetch_add(1) & ( NUM_STRIPES - 1 );
+   return myStripe;
+}
+
+// ========================================================================
+
+ConcurrentIntSet::ConcurrentIntSet()
+: current(new IntSet), generation(0)
+{
+   for( int s = 0; s < NUM_STRIPES; s ++ )
+   {
+      stripes[s].readers[0] = 0;
+      stripes[s].readers[1] = 0;
+   }
+}
+
+// ========================================================================
+
+ConcurrentIntSet::ConcurrentIntSet(const IntSet& initial)
+: current(new IntSet(initial)), generation(0)
+{
+   for( int s = 0; s < NUM_STRIPES; s ++ )
+   {
+      stripes[s].readers[0] = 0;
+      stripes[s].readers[1] = 0;
+   }
+}
+
+// ========================================================================
+
+ConcurrentIntSet::~ConcurrentIntSet()
+{
+   delete current.load();
+   for( size_t i = 0; i < retired.size(); i ++ )
+      delete retired[i].set;
+}
+
+// ========================================================================
+
+atomic<long>* ConcurrentIntSet::enterRead(const IntSet*& set) const
+
+// this function counts the reader under the parity of the generation it
+// sees, making sure the generation didn't move on in the meantime
+{
+   atomic<long>* readers;
+
+   for( ;; )
+   {
+      unsigned long g = generation.load();
+      readers = &stripes[stripeIndex()].readers[g & 1];
+      readers->fetch_add(1);
+      if( generation.load() == g )
+         break;
+      readers->fetch_sub(1);           // a writer got in: try again
+   }
+
+   set = current.load();
+   return readers;
+}
+
+// ========================================================================
+
+bool ConcurrentIntSet::drained(unsigned long parity) const
+{
+   for( int s = 0; s < NUM_STRIPES; s ++ )
+   {
+      if( stripes[s].readers[parity].load() != 0 )
+         return false;
+   }
+   return true;
+}
+
+// ========================================================================
+
+void ConcurrentIntSet::publish(IntSet* next)
+
+// this function swaps next in and retires the old snapshot, then moves
+// generation on while the readers of the generation before have all
+// left (twice at most: enough to free what was just retired), and
+// releases the snapshots retired 2 generations or more ago
+{
+   unsigned long g = generation.load();
+   Retired old = { current.exchange(next), g };
+   retired.push_back(old);
+
+   for( int step = 0; step < 2 && drained(( g + 1 ) & 1); step ++ )
+      generation.store(++ g);
+
+   size_t kept = 0;
+   for( size_t i = 0; i < retired.size(); i ++ )
+   {
+      if( retired[i].generation + 2 <= g )
+         delete retired[i].set;
+      else
+         retired[kept ++] = retired[i];
+   }
+   retired.resize(kept);
+}
+
+// ========================================================================
+
+bool ConcurrentIntSet::contains(int anInt) const
+{
+   const IntSet* set;
+   atomic<long>* readers = enterRead(set);
+   bool found = set->contains(anInt);
+   readers->fetch_sub(1, memory_order_release);
+   return found;
+}
+
+// ========================================================================
+
+int ConcurrentIntSet::size() const
+{
+   const IntSet* set;
+   atomic<long>* readers = enterRead(set);
+   int count = set->size();
+   readers->fetch_sub(1, memory_order_release);
+   return count;
+}
+
+// ========================================================================
+
+ConcurrentIntSet::Snapshot ConcurrentIntSet::snapshot() const
+{
+   const IntSet* set;
+   atomic<long>* readers = enterRead(set);
+   return Snapshot(readers, set);
+}
+
+// ========================================================================
+
+bool ConcurrentIntSet::add(int anInt)
+
+// this function publishes a copy with anInt added (no copy is made, and
+// nothing is published, if anInt is already a member)
+{
+   lock_guard<mutex> guard(writeLock);
+   const IntSet* set = current.load();
+
+   if( set->contains(anInt) )
+      return false;
+
+   IntSet* next = new IntSet(*set);
+   next->add(anInt);
+   publish(next);
+   return true;
+}
+
+// ========================================================================
+
+bool ConcurrentIntSet::remove(int anInt)
+
+// this function publishes a copy with anInt removed (no copy is made,
+// and nothing is published, if anInt isn't a member)
+{
+   lock_guard<mutex> guard(writeLock);
+   const IntSet* set = current.load();
+
+   if( !set->contains(anInt) )
+      return false;
+
+   IntSet* next = new IntSet(*set);
+   next->remove(anInt);
+   publish(next);
+   return true;
+}
+
+// ========================================================================
+
+int ConcurrentIntSet::addAll(const int* first, const int* last)
+{
+   lock_guard<mutex> guard(writeLock);
+   IntSet* next = new IntSet(*current.load());
+   int added = next->addAll(first, last);
+
+   if( added == 0 )
+   {
+      delete next;
+      return 0;
+   }
+   publish(next);
+   return added;
+}
+
+// ========================================================================
+
+void ConcurrentIntSet::reset()
+{
+   lock_guard<mutex> guard(writeLock);
+   publish(new IntSet);
+}
+
+// ========================================================================
+
+ConcurrentIntSet::Snapshot::Snapshot(atomic<long>* readers,
+                                     const IntSet* set)
+: readers(readers), set(set)
+{
+}
+
+// ========================================================================
+
+ConcurrentIntSet::Snapshot::Snapshot(Snapshot&& src) noexcept
+: readers(src.readers), set(src.set)
+{
+   src.readers = 0;                   // src no longer counts as a reader
+   src.set = 0;
+}
+
+// ========================================================================
+
+ConcurrentIntSet::Snapshot::~Snapshot()
+{
+   if( readers )
+      readers->fetch_sub(1, memory_order_release);
+}
+
+// ========================================================================
+
+bool ConcurrentIntSet::Snapshot::contains(int anInt) const
+{
+   return set->contains(anInt);
+}
+
+// ========================================================================
+
+int ConcurrentIntSet::Snapshot::size() const
+{
+   return set->size();
+}
+
+// ========================================================================
+
+bool ConcurrentIntSet::Snapshot::isEmpty() const
+{
+   return set->isEmpty();
+}
+
+// ========================================================================
+
+void ConcurrentIntSet::Snapshot::DumpData(ostream& out) const
+{
+   set->DumpData(out);
+}
+
+// ========================================================================
+
+IntSet ConcurrentIntSet::Snapshot::toIntSet() const
+{
+   return IntSet(*set);
+}
@@ -0,0 +1,162 @@
+// FILE: ConcurrentIntSet.h - header file for ConcurrentIntSet class
+// CLASS PROVIDED: ConcurrentIntSet (an IntSet that many threads may
+//                 read while another thread changes it)
+//
+// A ConcurrentIntSet is meant for read-mostly sharing: any number of
+// threads may call contains() (or take snapshots) at all times while
+// other threads add and remove values now and then. Readers never
+// wait: the collection is kept as an immutable IntSet "snapshot", and
+// a change builds a new snapshot (a changed copy of the current one)
+// and publishes it in a single atomic step. A reader sees either the
+// old or the new snapshot, never a half-made change. An old snapshot
+// is set aside, and released by a later change (or the destructor)
+// once no reader can still be using it; writers don't wait for
+// readers either.
+//
+// A change costs a copy of the whole collection, O(n), so changes
+// should be rare compared with lookups, or be batched with modify().
+// Writers are serialized by a mutex.
+//
+// CONSTRUCTORS
+//   ConcurrentIntSet()
+//     Pre:  (none)
+//     Post: The invoking ConcurrentIntSet is initialized to an empty
+//           set.
+//   explicit ConcurrentIntSet(const IntSet& initial)
+//     Pre:  (none)
+//     Post: The invoking ConcurrentIntSet is initialized to a copy of
+//           initial (membership order included).
+//
+// DESTRUCTOR
+//   ~ConcurrentIntSet()
+//     Pre:  No thread is using the invoking ConcurrentIntSet (or a
+//           Snapshot of it) any more.
+//
+// CONSTANT MEMBER FUNCTIONS (ACCESSORS) - safe to call from any thread
+//   bool contains(int anInt) const
+//   int size() const
+//     Pre:  (none)
+//     Post: As for IntSet, on the snapshot current at the time of the
+//           call. Neither function ever blocks.
+//   Snapshot snapshot() const
+//     Pre:  (none)
+//     Post: A Snapshot of the current collection is returned; it stays
+//           unchanged (and usable) for as long as the Snapshot lives,
+//           whatever changes are made in the meantime.
+//     Note: While a Snapshot lives, the snapshots replaced since it
+//           was taken are kept too (even by later changes), so
+//           Snapshots should not be held for long. The thread holding
+//           one may itself change the set, though.
+//
+// MODIFICATION MEMBER FUNCTIONS (MUTATORS) - safe to call from any thread
+//   bool add(int anInt)
+//   bool remove(int anInt)
+//   int addAll(const int* first, const int* last)
+//   void reset()
+//     Pre/Post: As for IntSet; the change becomes visible to readers
+//           all at once.
+//   template <class Function>
+//   void modify(Function change)
+//     Pre:  change can be called as change(IntSet&).
+//     Post: change has been applied to a copy of the current
+//           collection, and the result has been published as a
+//           whole (one copy for any number of changes).
+//
+// NESTED CLASS ConcurrentIntSet::Snapshot
+//   A read handle on one snapshot: movable, not copyable.
+//   bool contains(int anInt) const
+//   int size() const
+//   bool isEmpty() const
+//   void DumpData(std::ostream& out) const
+//     Pre/Post: As for IntSet, on the snapshot held.
+//   IntSet toIntSet() const
+//     Pre:  (none)
+//     Post: A private copy of the snapshot is returned (e.g. to run
+//           set operations on, which IntSet doesn't allow on an
+//           IntSet shared between threads).
+//
+// VALUE SEMANTICS
+//   ConcurrentIntSet objects may not be copied or assigned.
+
+#ifndef CONCURRENT_INT_SET_H
+#define CONCURRENT_INT_SET_H
+
+#include "IntSet.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <iostream>
+
+class ConcurrentIntSet
+{
+public:
+   class Snapshot
+   {
+   public:
+      Snapshot(Snapshot&& src) noexcept;
+      ~Snapshot();
+      bool contains(int anInt) const;
+      int size() const;
+      bool isEmpty() const;
+      void DumpData(std::ostream& out) const;
+      IntSet toIntSet() const;
+
+   private:
+      friend class ConcurrentIntSet;
+      Snapshot(std::atomic<long>* readers, const IntSet* set);
+      Snapshot(const Snapshot&);               // not copyable
+      Snapshot& operator=(const Snapshot&);
+      std::atomic<long>* readers;
+      const IntSet* set;
+   };
+
+   ConcurrentIntSet();
+   explicit ConcurrentIntSet(const IntSet& initial);
+   ~ConcurrentIntSet();
+   bool contains(int anInt) const;
+   int size() const;
+   Snapshot snapshot() const;
+   bool add(int anInt);
+   bool remove(int anInt);
+   int addAll(const int* first, const int* last);
+   void reset();
+   template <class Function>
+   void modify(Function change);
+
+private:
+   static const int NUM_STRIPES = 64;
+   static_assert(( NUM_STRIPES & ( NUM_STRIPES - 1 ) ) == 0,
+                 "NUM_STRIPES must be a power of 2");
+   struct Stripe
+   {
+      std::atomic<long> readers[2];
+      char pad[64 - 2 * sizeof(std::atomic<long>)];
+   };
+   struct Retired
+   {
+      const IntSet* set;
+      unsigned long generation;
+   };
+   std::atomic<const IntSet*> current;
+   std::atomic<unsigned long> generation;
+   mutable Stripe stripes[NUM_STRIPES];
+   std::mutex writeLock;
+   std::vector<Retired> retired;
+   ConcurrentIntSet(const ConcurrentIntSet&);  // not copyable
+   ConcurrentIntSet& operator=(const ConcurrentIntSet&);
+   static int stripeIndex();
+   std::atomic<long>* enterRead(const IntSet*& set) const;
+   bool drained(unsigned long parity) const;
+   void publish(IntSet* next);
+};
+
+template <class Function>
+void ConcurrentIntSet::modify(Function change)
+{
+   std::lock_guard<std::mutex> guard(writeLock);
+   IntSet* next = new IntSet(*current.load());
+   change(*next);
+   publish(next);
+}
+
+#endif
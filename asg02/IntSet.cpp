@@ -5,6 +5,7 @@
 // (1) Distinct int values of the IntSet are stored in a 1-D,
 //     dynamic array whose size is stored in member variable
 //     capacity; the member variable data references the array.
+//     (When capacity is 0, data is 0 and references no array.)
 // (2) The distinct int value with earliest membership is stored
 //     in data[0], the distinct int value with the 2nd-earliest
 //     membership is stored in data[1], and so on.
@@ -19,12 +20,15 @@
 //           has no effect on the "membership timing" of that int
 //           value.
 // (4) The # of distinct int values the IntSet currently contains
-//     is stored in the member variable used.
+//     is stored in the member variable used...
+//     ...EXCEPT for the dead places described in (9), i.e., the #
+//     is really used - holes.
 // (5) Except when the IntSet is empty (used == 0), ALL elements
 //     of data from data[0] until data[used - 1] contain relevant
 //     distinct int values; i.e., all relevant distinct int values
 //     appear together (no "holes" among them) starting from the
-//     beginning of the data array.
+//     beginning of the data array...
+//     ...EXCEPT for the dead places described in (9).
 // (6) We DON'T care what is stored in any of the array elements
 //     from data[used] through data[capacity - 1].
 //     Note: This applies also when the IntSet is empry (used == 0)
@@ -40,8 +44,68 @@
 //           the data array and used (if properly initialized and
 //           maintained) should tell which elements of the data
 //           array are actually relevant.
+// (7) Once the IntSet holds INDEX_THRESHOLD or more values, it may
+//     also carry a hash index: a 1-D, dynamic array of indexSize
+//     "slots" referenced by the member variable index, searched by
+//     open addressing (linear probing).
+//     Note: Each relevant distinct int value has exactly one slot,
+//           which holds the position (in data) of that value; all
+//           other slots are free and hold -1. Since a slot holds a
+//           position rather than the value itself, every int value
+//           can be a member (no value is reserved as "free").
+//     Note: indexSize is always a power of 2 and is kept at least
+//           twice used, so probe sequences stay short and always
+//           end at a free slot.
+//     Note: When there is no index, index is 0 and indexSize is 0,
+//           and lookups fall back to scanning data[0..used - 1].
+// (8) The member variable sorted may reference a "sorted view" of the
+//     IntSet: a 1-D, dynamic array of used Entry's, each pairing a
+//     relevant value with its position in data, in ascending order of
+//     value. The view is built lazily (by the first set operation that
+//     needs it) and reused until the IntSet is next modified; member
+//     variable sortedValid tells whether it is current.
+//     Note: sorted and sortedValid are mutable because (re)building
+//           the view doesn't change the collection the IntSet
+//           represents, so const set operations may do it.
+// (9) When remove() works in TOMBSTONE mode (member variable
+//     deadRatio > 0; it is 0 in SHIFT mode), a removed value's
+//     position in data is not closed up but marked "dead": the
+//     member variable dead references a 1-D, dynamic array of
+//     capacity flags (allocated on the first such removal), dead[i]
+//     is 1 if data[i] is dead and 0 otherwise (for i < used), and
+//     the member variable holes is the # of dead places among
+//     data[0..used - 1].
+//     Note: Dead values are not in the hash index, and only an
+//           IntSet with a hash index ever has dead places.
+//     Note: When holes exceeds deadRatio * used, the dead places are
+//           squeezed out (compacted), so that removal is amortized
+//           O(1) while the wasted space stays bounded.
+// (10) The member variables fpSum and fpXor hold the fingerprint of
+//     the collection: the sum and the exclusive or (both modulo 2^32)
+//     of fingerprintOf(v) over every relevant value v. Being sums,
+//     they don't depend on membership order, and each is updated in
+//     O(1) whenever a value joins or leaves the IntSet.
+//     Note: Equal IntSet's always have equal fingerprints, so sets
+//           whose fingerprints differ are known to be unequal without
+//           looking at a single value.
+// (11) The member variable bloom is 0, or references a Bloom filter
+//     (see IntSetBloom.h) in which every relevant value has been
+//     inserted (values removed since it was last built may be in it
+//     too), so contains() may return false when it says "no".
+// (12) The member variable growth is the policy by which the array is
+//     grown when it is full, and stats counts the allocations of the
+//     array (and builds of the index) made since the IntSet was made
+//     (or its stats were last reset).
+// (13) If compiled with INTSET_STATS defined, the member variable
+//     opCounters counts the work of the operations on the IntSet, and
+//     the static member variable globalCounters that of all IntSet's
+//     (see IntSetStats.h); every function that compares, moves or
+//     copies values, or reallocates data, counts it with INTSET_COUNT.
+// (14) The member variable sketch is 0, or references a sketch (see
+//     IntSetSketch.h) in which every relevant value has been recorded
+//     (values removed since it was last cleared may be in it too).
 //
-// DOCUMENTATION for private member (helper) function:
+// DOCUMENTATION for private member (helper) functions:
 //   void resize(int new_capacity)
 //     Pre:  (none)
 //           Note: Recall that one of the things a constructor
@@ -70,40 +134,504 @@
 //           If reallocation of dynamic array is unsuccessful, an
 //           error message to the effect is displayed and the
 //           program unconditionally terminated.
+//     Note: The data array is reallocated in place (positions
+//           don't change), so the index and sorted view stay valid.
+//   int grownCapacity(int needed) const
+//     Pre:  needed > capacity
+//     Post: The capacity the growth policy (member variable growth)
+//           gives for an IntSet that needs room for needed values is
+//           returned (never less than needed).
+//   void steal(IntSet& src)
+//     Pre:  The invoking IntSet owns no dynamic memory (it has just
+//           been constructed or its memory has been released).
+//     Post: The invoking IntSet has taken over the contents and the
+//           dynamic memory of src, and src has been left as a valid
+//           empty IntSet that owns no dynamic memory (capacity 0).
+//   bool isLive(int pos) const
+//     Pre:  0 <= pos < used
+//     Post: True is returned if data[pos] is a relevant value (i.e.,
+//           not dead, see invariant 9), otherwise false is returned.
+//   void keepFlagged(const char* hit, char keep)
+//     Pre:  hit has used elements, each 0 or 1.
+//     Post: Only the live values data[i] for which hit[i] == keep
+//           remain in the invoking IntSet (still in membership order,
+//           with no dead places), and the index has been rebuilt to
+//           match.
+//   void memberIn(int anInt)
+//   void memberOut(int anInt)
+//     Pre:  anInt has just joined (left) the collection.
+//     Post: The fingerprint (see invariant 10), and the Bloom filter
+//           (see invariant 11) and the sketch (see invariant 14), if
+//           any, account for it.
+//   void summaryUpkeep()
+//     Pre:  (none)
+//     Post: If the Bloom filter is too full or too stale (see
+//           IntBloomFilter::needsRebuild), it has been rebuilt, and so
+//           has the sketch if it is too stale.
+//     Note: Must be called at the end of each function that changes
+//           the collection.
+//   void rebuildBloom()
+//     Pre:  bloom != 0
+//     Post: The Bloom filter has been resized for twice the current #
+//           of values and refilled with the relevant values.
+//   void rebuildSketch()
+//     Pre:  sketch != 0
+//     Post: The sketch has been cleared and refilled with the relevant
+//           values.
+//   int countCommon(const IntSet& otherIntSet) const
+//     Pre:  (none)
+//     Post: The # of relevant values of the invoking IntSet that are
+//           also in otherIntSet is returned.
+//   static int homeSlot(int anInt, int mask)
+//     Pre:  mask is indexSize - 1 for some index size.
+//     Post: The slot where the probe sequence for anInt begins is
+//           returned.
+//   static unsigned int fingerprintOf(int anInt)
+//     Post: anInt's part of the fingerprint (see invariant 10) is
+//           returned.
+//   static int indexSizeFor(int numVals)
+//     Post: The # of slots for an index freshly built over numVals
+//           values is returned.
+//   int findSlot(int anInt) const
+//     Pre:  indexSize > 0
+//     Post: If anInt is a relevant value, the # of the slot that
+//           holds its position is returned, otherwise the # of the
+//           free slot at which the probe sequence for anInt ends
+//           (i.e., where anInt would be indexed) is returned.
+//   void buildIndex(int new_size)
+//     Pre:  new_size is a power of 2 and new_size >= 2 * used
+//     Post: Any existing index is discarded and a new index with
+//           new_size slots is built over data[0..used - 1].
+//   void syncIndex()
+//     Pre:  data[0..used - 1] has been filled without maintaining
+//           the index (and the invoking IntSet has no index).
+//     Post: If used >= INDEX_THRESHOLD, an index has been built;
+//           otherwise the invoking IntSet is unchanged.
+//   void indexInsert(int pos)
+//     Pre:  data[pos] is a relevant value that is not yet indexed.
+//     Post: data[pos] is indexed (if the invoking IntSet has an
+//           index, or has just reached INDEX_THRESHOLD values); the
+//           index is rebuilt larger first if it would be more than
+//           half full.
+//   const Entry* sortedView() const
+//     Pre:  (none)
+//     Post: The sorted view of the invoking IntSet (see invariant 8)
+//           is returned, having been (re)built first if it was not
+//           current.
+//   void invalidateSorted()
+//     Pre:  (none)
+//     Post: The sorted view is marked as no longer current; it must
+//           be called by every function that changes data[].
+//   int matchSorted(const IntSet& otherIntSet,
+//                   char* thisHit, char* otherHit) const
+//     Pre:  thisHit (if not 0) has used zeroed elements and otherHit
+//           (if not 0) has otherIntSet.used zeroed elements.
+//     Post: The # of values common to the invoking IntSet and
+//           otherIntSet is returned; for each common value, the
+//           element of thisHit (of otherHit) at the value's position
+//           in data (in otherIntSet.data) has been set to 1 (dead
+//           places are never flagged).
+//     Note: If n * m <= SCAN_LIMIT (and neither IntSet has dead
+//           places), the values are just looked up
+//           with the SIMD scan kernel (see IntSetKernels.h) since
+//           that beats sorting for small sets; otherwise the
+//           sorted views are merged in O(n + m) time, except when
+//           one is more than GALLOP_RATIO times the size of the other,
+//           in which case each value of the smaller one is located in
+//           the larger one by galloping (exponential) search instead.
+//   int gallop(const Entry* view, int lo, int hi, int target) const
+//     Pre:  view[lo..hi - 1] is in ascending order of value.
+//     Post: The lowest k in [lo, hi] such that k == hi or
+//           view[k].value >= target is returned, found in time
+//           logarithmic in (k - lo).
+//   void indexErase(int slot)
+//     Pre:  indexSize > 0 and slot holds a position.
+//     Post: slot is freed and the slots that follow it in the same
+//           probe run are shifted back so that every remaining
+//           value stays reachable from its home slot.
+//   (markParallel, appendMarked and buildIndexParallel, the helpers of
+//   the parallel set operations, are documented in IntSetParallel.cpp)
 
 #include "IntSet.h"
+#include "IntSetKernels.h"
+#include "IntSetBloom.h"
+#include "IntSetSketch.h"
 #include <iostream>
-#include <cassert>
+#include <locale>
+#include <algorithm>
+#include <queue>
+#include <vector>
 using namespace std;
 
 // ========================================================================
 
+int IntSet::homeSlot(int anInt, int mask)
+
+// this function scrambles the bits of anInt (32-bit finalizer from
+// MurmurHash3) and returns the slot where its probe sequence begins
+{
+   unsigned int h = static_cast<unsigned int>(anInt);
+   h ^= h >> 16;
+   h *= 0x85ebca6bU;
+   h ^= h >> 13;
+   h *= 0xc2b2ae35U;
+   h ^= h >> 16;
+   return static_cast<int>(h & static_cast<unsigned int>(mask));
+}
+
+// ========================================================================
+
+unsigned int IntSet::fingerprintOf(int anInt)
+
+// this function scrambles anInt with a different seed than homeSlot, so
+// that values colliding in the index don't also collide in fingerprints
+{
+   unsigned int h = static_cast<unsigned int>(anInt) ^ 0x9e3779b9U;
+   h ^= h >> 16;
+   h *= 0x7feb352dU;
+   h ^= h >> 15;
+   h *= 0x846ca68bU;
+   h ^= h >> 16;
+   return h;
+}
+
+// ========================================================================
+
+int IntSet::indexSizeFor(int numVals)
+
+// this function returns the # of slots for a freshly built index: the
+// smallest power of 2 that leaves the index no more than 1/4 full
+// (so it can double in size before it has to be rebuilt again)
+{
+   int new_size = 64;
+   while( new_size < 4 * numVals )
+      new_size *= 2;
+   return new_size;
+}
+
+// ========================================================================
+
+int IntSet::findSlot(int anInt) const
+
+// this function walks the probe sequence for anInt until it finds the
+// slot holding anInt's position or the free slot that ends the sequence
+{
+   int mask = indexSize - 1;
+   int slot = homeSlot(anInt, mask);
+
+   INTSET_COUNT(comparisons, 1);
+   while( index[slot] != -1 && data[index[slot]] != anInt )
+   {
+      slot = ( slot + 1 ) & mask;
+      INTSET_COUNT(comparisons, 1);
+   }
+
+   return slot;
+}
+
+// ========================================================================
+
+void IntSet::buildIndex(int new_size)
+
+// this function throws away the current index (if any) and indexes
+// every relevant value again in a new table of new_size slots
+{
+   delete [] index;
+   index = new int[new_size];
+   indexSize = new_size;
+   stats.indexBuilds ++;
+
+   for( int s = 0; s < indexSize; s ++ )
+      index[s] = -1;
+
+   for( int i = 0; i < used; i ++ )
+      if( isLive(i) )
+         index[findSlot(data[i])] = i;
+}
+
+// ========================================================================
+
+void IntSet::syncIndex()
+
+// this function is called after data[] has been filled directly (as the
+// set operations do) to give a large enough result IntSet its index
+{
+   if( used >= INDEX_THRESHOLD )
+      buildIndex(indexSizeFor(used));
+}
+
+// ========================================================================
+
+void IntSet::indexInsert(int pos)
+
+// this function records the position of a newly appended value in the
+// index, building or growing the index first if needed
+{
+   if( indexSize == 0 )
+   {
+      syncIndex();                     // first time over the threshold
+   }
+   else if( 2 * used > indexSize )     // index would be over half full
+   {
+      buildIndex(indexSizeFor(used));
+   }
+   else
+      index[findSlot(data[pos])] = pos;
+}
+
+// ========================================================================
+
+void IntSet::indexErase(int slot)
+
+// this function frees a slot by "backward shift" deletion: each later
+// slot in the same run moves back into the hole unless its home slot
+// lies after the hole (in which case moving it would make it unreachable)
+{
+   int mask = indexSize - 1;
+   int hole = slot;
+   int next = ( hole + 1 ) & mask;
+
+   while( index[next] != -1 )
+   {
+      int home = homeSlot(data[index[next]], mask);
+
+      if( ( ( next - home ) & mask ) >= ( ( next - hole ) & mask ) )
+      {
+         index[hole] = index[next];
+         hole = next;
+      }
+      next = ( next + 1 ) & mask;
+   }
+
+   index[hole] = -1;
+}
+
+// ========================================================================
+
+const IntSet::Entry* IntSet::sortedView() const
+
+// this function pairs every relevant value with its position and sorts
+// the pairs by value, unless the sorted view is already current
+{
+   if( !sortedValid )
+   {
+      delete [] sorted;
+      sorted = new Entry[used > 0 ? used : 1];
+
+      int live = 0;
+      for( int i = 0; i < used; i ++ )
+      {
+         if( isLive(i) )
+         {
+            sorted[live].value = data[i];
+            sorted[live].pos = i;
+            live ++;
+         }
+      }
+#ifdef INTSET_STATS
+      unsigned long long compares = 0;
+      sort(sorted, sorted + live, [&compares](const Entry& x, const Entry& y)
+           { compares ++; return x < y; });
+      INTSET_COUNT(comparisons, compares);
+#else
+      sort(sorted, sorted + live);
+#endif
+
+      sortedValid = true;
+   }
+
+   return sorted;
+}
+
+// ========================================================================
+
+void IntSet::invalidateSorted()
+
+// this function marks the sorted view stale (its memory is reused or
+// released the next time the view is built)
+{
+   sortedValid = false;
+}
+
+// ========================================================================
+
+int IntSet::gallop(const Entry* view, int lo, int hi, int target) const
+
+// this function first probes view[lo], view[lo + 1], view[lo + 3],
+// view[lo + 7], ... until it passes target, and then binary searches
+// the last (doubling) step for the exact spot
+{
+   int step = 1;
+   int bound = lo;
+
+   while( bound < hi && view[bound].value < target )
+   {
+      INTSET_COUNT(comparisons, 1);
+      lo = bound + 1;               // everything up to bound is < target
+      bound += step;
+      step *= 2;
+   }
+   if( bound > hi )
+      bound = hi;
+
+   while( lo < bound )              // answer is in [lo, bound]
+   {
+      int mid = lo + ( bound - lo ) / 2;
+      INTSET_COUNT(comparisons, 1);
+      if( view[mid].value < target )
+         lo = mid + 1;
+      else
+         bound = mid;
+   }
+
+   return lo;
+}
+
+// ========================================================================
+
+int IntSet::matchSorted(const IntSet& otherIntSet,
+                        char* thisHit, char* otherHit) const
+
+// this function walks the sorted views of both IntSets side by side
+// (or gallops through the larger one if the sizes are lopsided) and
+// flags the positions of every value the two IntSets have in common
+{
+   int n = size();
+   int m = otherIntSet.size();
+
+   if( holes == 0 && otherIntSet.holes == 0 &&
+       ( m == 0 || n <= SCAN_LIMIT / m ) ) // small enough to skip sorting
+   {
+      INTSET_COUNT(comparisons, static_cast<unsigned long long>(n) * m);
+      return scanMatch(data, n, otherIntSet.data, m, thisHit, otherHit);
+   }
+
+   const Entry* a = sortedView();
+   const Entry* b = otherIntSet.sortedView();
+   int i = 0;
+   int j = 0;
+   int common = 0;
+
+   if( n < m / GALLOP_RATIO )             // this IntSet is much smaller
+   {
+      for( i = 0; i < n && j < m; i ++ )
+      {
+         j = gallop(b, j, m, a[i].value);
+         if( j < m && b[j].value == a[i].value )
+         {
+            if( thisHit )  thisHit[a[i].pos] = 1;
+            if( otherHit ) otherHit[b[j].pos] = 1;
+            common ++;
+            j ++;
+         }
+      }
+   }
+   else if( m < n / GALLOP_RATIO )        // otherIntSet is much smaller
+   {
+      for( j = 0; j < m && i < n; j ++ )
+      {
+         i = gallop(a, i, n, b[j].value);
+         if( i < n && a[i].value == b[j].value )
+         {
+            if( thisHit )  thisHit[a[i].pos] = 1;
+            if( otherHit ) otherHit[b[j].pos] = 1;
+            common ++;
+            i ++;
+         }
+      }
+   }
+   else                                   // plain linear merge
+   {
+      while( i < n && j < m )
+      {
+         INTSET_COUNT(comparisons, 1);
+         if( a[i].value < b[j].value )
+            i ++;
+         else if( b[j].value < a[i].value )
+            j ++;
+         else
+         {
+            if( thisHit )  thisHit[a[i].pos] = 1;
+            if( otherHit ) otherHit[b[j].pos] = 1;
+            common ++;
+            i ++;
+            j ++;
+         }
+      }
+   }
+
+   return common;
+}
+
+// ========================================================================
+
 void IntSet::resize(int new_capacity)
 
-// this function creates a new IntSet object with the desired capacity
-// and then copies the relevant data from the "this" IntSet into it 
-// and then returns the revised object to the calling function
-// (the temporary memory allocation is destroyed upon losing scope)
+// this function allocates an array of the desired capacity, copies the
+// relevant data over and releases the old array (positions are kept,
+// so the index and the sorted view don't need to be touched)
 {
    if( new_capacity < used )	    // make sure new_capacity is at least		
       new_capacity = used;          // big enough for current contents
 
      
-   else if( new_capacity == 0 )     // if new_capacity is 0, then
+   if( new_capacity == 0 )          // if new_capacity is 0, then
       new_capacity = 1;             // new_capacity = DEFAULT_CAPACITY
 
     
-   IntSet tempSet(new_capacity);    // create a temp IntSet obj w/new cap            
-   tempSet.used = used;             // and copy "this" IntSet into it						
+   int* nuData = new int[new_capacity];
 
    for( int i = 0; i < used; i ++ )   
    {								  
-      tempSet.data[i] = data[i];
+      nuData[i] = data[i];
+   }
+
+   delete [] data;
+   data = nuData;
+
+   stats.allocations ++;            // (see allocStats)
+   stats.intsCopied += used;
+   INTSET_COUNT(reallocations, 1);
+   INTSET_COUNT(bytesCopied, used * sizeof(int));
+   if( new_capacity > stats.peakCapacity )
+      stats.peakCapacity = new_capacity;
+
+   if( dead )                       // dead flags follow the same layout
+   {
+      char* nuDead = new char[new_capacity]();
+      for( int i = 0; i < used; i ++ )
+         nuDead[i] = dead[i];
+      delete [] dead;
+      dead = nuDead;
    }
 
-   *this = tempSet;                 // re: memory management, the stale 
-                                    // stale memory for this.data is 
-                                    // deleted by overloaded operator=() 
+   capacity = new_capacity;
+}
+
+// ========================================================================
+
+int IntSet::grownCapacity(int needed) const
+
+// this function applies the growth policy: the capacity times factor,
+// but at least minStep more, at least needed, and (if asked) rounded up
+// to whole pages
+{
+   double next = capacity * growth.factor;
+   if( next < static_cast<double>(capacity) + growth.minStep )
+      next = static_cast<double>(capacity) + growth.minStep;
+   if( next < needed )
+      next = needed;
+   if( next > MAX_CAPACITY )
+      next = MAX_CAPACITY;
+
+   int new_capacity = static_cast<int>(next);
+
+   int perPage = growth.pageBytes / static_cast<int>( sizeof(int) );
+   if( perPage > 1 && new_capacity % perPage != 0 &&
+       new_capacity <= MAX_CAPACITY - perPage )
+      new_capacity += perPage - new_capacity % perPage;
+
+   return new_capacity;
 }
 
 // ========================================================================
@@ -114,7 +642,21 @@ IntSet::IntSet(int initial_capacity)
 {
    capacity = initial_capacity;    // DEFAULT_CAPACITY = 1;
    used = 0;                       
-   data = new int[capacity];       
+   data = ( capacity > 0 ) ? new int[capacity] : 0;   // (no block for 0,
+                                                      //  as when moved from)
+   index = 0;                      // small sets start without an index
+   indexSize = 0;
+   sorted = 0;                     // sorted view is built on demand
+   sortedValid = false;
+   dead = 0;                       // SHIFT mode, no dead places
+   holes = 0;
+   deadRatio = 0;
+   fpSum = 0;                      // fingerprint of the empty set
+   fpXor = 0;
+   bloom = 0;                      // no Bloom filter unless asked for
+   sketch = 0;                     // nor sketch
+   stats.allocations = 1;          // (growth is the default policy)
+   stats.peakCapacity = capacity;
 }
 
 // ========================================================================
@@ -125,11 +667,90 @@ IntSet::IntSet(const IntSet& src)
 {
    used = src.used;  
    capacity = src.capacity;        
-   data = new int[capacity];      
+   data = ( capacity > 0 ) ? new int[capacity] : 0;
    for( int i = 0; i < src.used; i ++ )
    {
       data[i] = src.data[i];
    }
+
+   indexSize = src.indexSize;      // positions are the same in the
+   index = 0;                      // copy, so the index copies as is
+   if( indexSize > 0 )
+   {
+      index = new int[indexSize];
+      for( int s = 0; s < indexSize; s ++ )
+         index[s] = src.index[s];
+   }
+
+   sorted = 0;                     // the copy builds its own sorted
+   sortedValid = false;            // view if and when it needs one
+
+   holes = src.holes;              // dead places copy as they are too
+   deadRatio = src.deadRatio;
+   fpSum = src.fpSum;
+   fpXor = src.fpXor;
+   bloom = src.bloom ? new IntBloomFilter(*src.bloom) : 0;
+   sketch = src.sketch ? new IntSetSketch(*src.sketch) : 0;
+   growth = src.growth;            // the copy grows the same way, but
+   stats.allocations = 1;          // counts its own allocations
+   stats.peakCapacity = capacity;
+   dead = 0;
+   if( src.dead )
+   {
+      dead = new char[capacity]();
+      for( int i = 0; i < used; i ++ )
+         dead[i] = src.dead[i];
+   }
+   INTSET_COUNT(bytesCopied, ( used + indexSize ) * sizeof(int));
+}
+
+// ========================================================================
+
+void IntSet::steal(IntSet& src)
+
+// this function moves src's members (pointers included) into "this" and
+// leaves src empty, without allocating or copying anything
+{
+   data = src.data;
+   capacity = src.capacity;
+   used = src.used;
+   index = src.index;
+   indexSize = src.indexSize;
+   sorted = src.sorted;
+   sortedValid = src.sortedValid;
+   dead = src.dead;
+   holes = src.holes;
+   deadRatio = src.deadRatio;
+   fpSum = src.fpSum;
+   fpXor = src.fpXor;
+   bloom = src.bloom;
+   sketch = src.sketch;
+   growth = src.growth;
+   stats = src.stats;
+
+   src.data = 0;                   // capacity 0: add() will allocate
+   src.capacity = 0;
+   src.used = 0;
+   src.index = 0;
+   src.indexSize = 0;
+   src.sorted = 0;
+   src.sortedValid = false;
+   src.dead = 0;
+   src.holes = 0;
+   src.fpSum = 0;
+   src.fpXor = 0;
+   src.bloom = 0;
+   src.sketch = 0;
+   src.stats = AllocStats();
+}
+
+// ========================================================================
+
+IntSet::IntSet(IntSet&& src) noexcept
+
+// this function is a move constructor for the IntSet class
+{
+   steal(src);
 }
 
 // ========================================================================
@@ -139,6 +760,11 @@ IntSet::~IntSet()
 // this function is the destructor for the IntSet class 
 {
    delete [] data;
+   delete [] index;
+   delete [] sorted;
+   delete [] dead;
+   delete bloom;
+   delete sketch;
 }
 
 // ========================================================================
@@ -148,12 +774,17 @@ IntSet& IntSet::operator=(const IntSet& rhs)
 // this function overloads the assignment operator for the IntSet class
 // and copies the rhs instance into the lhs instance
 {
-   if( capacity > 0 )                  // this conditional will be useful   
-      delete [] data;                  // if the DEFAULT_CAPACITY is ever 
-                                       // changed to 0 by a maintenance
-                                       // programmer 
+   if( this == &rhs )                  // self-assignment: nothing to do
+      return *this;
+
+   delete [] data;                     // (0, with capacity 0, if "this"
+                                       //  was moved from)
    capacity = rhs.capacity;    
-   data = new int[capacity];  
+   data = ( capacity > 0 ) ? new int[capacity] : 0;
+   stats.allocations ++;
+   if( capacity > stats.peakCapacity )
+      stats.peakCapacity = capacity;
+   growth = rhs.growth;
    used = rhs.used;          
     
    for( int i = 0; i < used; i ++ )   
@@ -161,17 +792,68 @@ IntSet& IntSet::operator=(const IntSet& rhs)
       data[i] = rhs.data[i];
    }
 
+   delete [] index;                    // copy rhs's index as well
+   index = 0;
+   indexSize = rhs.indexSize;
+   if( indexSize > 0 )
+   {
+      index = new int[indexSize];
+      for( int s = 0; s < indexSize; s ++ )
+         index[s] = rhs.index[s];
+   }
+
+   invalidateSorted();
+
+   delete [] dead;                     // and its dead places
+   dead = 0;
+   holes = rhs.holes;
+   deadRatio = rhs.deadRatio;
+   fpSum = rhs.fpSum;
+   fpXor = rhs.fpXor;
+   delete bloom;                       // and its Bloom filter
+   bloom = rhs.bloom ? new IntBloomFilter(*rhs.bloom) : 0;
+   delete sketch;                      // and its sketch
+   sketch = rhs.sketch ? new IntSetSketch(*rhs.sketch) : 0;
+   if( rhs.dead )
+   {
+      dead = new char[capacity]();
+      for( int i = 0; i < used; i ++ )
+         dead[i] = rhs.dead[i];
+   }
+   INTSET_COUNT(bytesCopied, ( used + indexSize ) * sizeof(int));
+
    return *this;               
 }
 
 // ========================================================================
 
+IntSet& IntSet::operator=(IntSet&& rhs) noexcept
+
+// this function overloads the move assignment operator for the IntSet
+// class: "this" releases its own memory and takes over rhs's
+{
+   if( this == &rhs )
+      return *this;
+
+   delete [] data;
+   delete [] index;
+   delete [] sorted;
+   delete [] dead;
+   delete bloom;
+   delete sketch;
+   steal(rhs);
+
+   return *this;
+}
+
+// ========================================================================
+
 int IntSet::size() const
 
 // this function returns the object's current number of relevant data items 
-// per the "used" member variable
+// per the "used" member variable (less any dead places)
 {
-   return used;					
+   return used - holes;					
 }
 
 // ========================================================================
@@ -182,27 +864,27 @@ bool IntSet::isEmpty() const
 // relevant data values and returns false if one or more relevant
 // data values exist   
 {
-   return ( used == 0 );		
+   return ( used == holes );		
 }
 
 // ========================================================================
 
 bool IntSet::contains(int anInt) const
 
-// this function iterates through the relevant data values, and 
+// this function looks anInt up in the hash index if there is one;
+// otherwise it iterates through the relevant data values, and 
 // if anInt is found, it returns true, else it returns false
 {
-   if( !isEmpty() ){
-      for( int i = 0; i < used; i ++ )	// iterate thru relevant values
-	  {
-         if( data[i] == anInt )			
-         {
-            return true;                // return true if anInt == found
-         }
-      }
-   }
-    
-   return false;                        // return false if anInt != found
+   if( bloom && !bloom->mayContain(anInt) )   // a sure miss
+      return false;
+
+   if( indexSize > 0 )
+      return ( index[findSlot(anInt)] != -1 );
+
+   // iterate thru relevant values (4 or 8 at a time, see IntSetKernels.h)
+   int pos = findInt(data, used, anInt);
+   INTSET_COUNT(comparisons, ( pos == -1 ) ? used : pos + 1);
+   return ( pos != -1 );
 }
 
 // ========================================================================
@@ -217,213 +899,296 @@ bool IntSet::isSubsetOf(const IntSet& otherIntSet) const
       return true; 
 
    // if IntSet size > otherIntSet size, it's not a subset, so return false
-   else if( used > otherIntSet.used )   
+   else if( size() > otherIntSet.size() )   
    {
       return false;
    }
 
+   // if the sizes are equal, being a subset means being equal, which
+   //    the fingerprints can usually rule out in O(1)
+   else if( size() == otherIntSet.size() )
+   {
+      return ( *this == otherIntSet );
+   }
+
    // else if IntSet size <= otherIntSet size, then confirm that all 
-   //    relevant values in IntSet exist in otherIntSet
+   //    relevant values in IntSet exist in otherIntSet (by merging the
+   //    sorted views and counting the values found in both)
    else
    {
-      int foundCount = 0;           
-
-      int thisNumVals = used;               // outer loop sentinel
-      int otherNumVals = otherIntSet.used;  // inner loop sentinel
-
-      for( int thisI = 0; thisI < thisNumVals; thisI ++ )
-      {
-         for( int otherI = 0 ; otherI < otherNumVals; otherI ++ )
-         {
-            if( this->data[thisI] == otherIntSet.data[otherI] )
-            foundCount ++;
-         }
-      }
-       
-      if( foundCount == used )              // if all IntSet vals == found				  
-         return true;                       // then return true 				
-      else 
-      return false;                         // else return false					
+      return ( matchSorted(otherIntSet, 0, 0) == size() );
    }
 }
 
 // ========================================================================
 
-void IntSet::DumpData(ostream& out) const
-{  // already implemented ... DON'T change anything
-   if (used > 0)
+static const int MAX_INT_CHARS = 11;     // "-2147483648"
+static const size_t DUMP_CHUNK = 65536;  // most chars DumpData buffers
+
+static char* formatInt(char* p, int anInt)
+
+// this function writes anInt in decimal at p (as ostream's << would with
+// the default flags) and returns the position just past it; the digits
+// are produced two at a time from a table, back to front
+{
+   static const char PAIRS[] =
+      "00010203040506070809101112131415161718192021222324252627282930313233"
+      "34353637383940414243444546474849505152535455565758596061626364656667"
+      "6869707172737475767778798081828384858687888990919293949596979899";
+
+   unsigned int u = static_cast<unsigned int>(anInt);
+   if( anInt < 0 )
+   {
+      *p ++ = '-';
+      u = 0U - u;
+   }
+
+   int len = 1;
+   for( unsigned int rest = u; rest >= 10; rest /= 10 )
+      len ++;
+
+   char* end = p + len;
+   char* q = end;
+   while( u >= 100 )
+   {
+      unsigned int pair = ( u % 100 ) * 2;
+      u /= 100;
+      *-- q = PAIRS[pair + 1];
+      *-- q = PAIRS[pair];
+   }
+   if( u >= 10 )
    {
-      out << data[0];
-      for (int i = 1; i < used; ++i)
-         out << "  " << data[i];
+      *-- q = PAIRS[u * 2 + 1];
+      *-- q = PAIRS[u * 2];
    }
+   else
+      *-- q = static_cast<char>( '0' + u );
+   return end;
 }
 
 // ========================================================================
 
-IntSet IntSet::unionWith(const IntSet& otherIntSet) const
+void IntSet::DumpData(ostream& out) const
 
-// this function creates a temporary IntSet object to collect the union of
-// relevant data values from IntSet and otherIntSet; the sequence 
-// of values is maintained while duplicates are removed; if the union 
-// requires more capacity, resize() is called;
+// this function formats the values into a buffer of at most DUMP_CHUNK
+// chars, writing it to out each time it fills up, instead of inserting
+// each value and separator into out on its own; that gives the same
+// text only with out's default format, so with any other (a base other
+// than decimal, showpos, a width or digit grouping) the values are
+// inserted one by one as before
 {
-   int totUnionVals = 0;                  // var to count # vals in union
-    
-   IntSet tempArray(capacity);            // create tempIntSet object
-
-   int tempIndex = 0;                     // var to mark the index where
-                                          // the union values from 
-                                          // otherIntSet should begin
-                                          // to be inserted
-
-   bool tempFlag = false;                 // this flag used to mark dupes 
-								
-   
-   // use an outer loop to copy IntSet values into tempArray;
-   // use an inner loop to count up dupe values so that afterward
-   // we can compute # values needed in final union:
-   
-   for( int i = 0; i < used; i ++ )
-   {
-      tempArray.data[i] = data[i];
-      tempArray.used ++;
-      tempIndex ++;
+   size_t live = size();
+   if( live == 0 )
+      return;
 
-      for( int i2 = 0; i2 < otherIntSet.used; i2 ++ )
+   if( ( out.flags() & ( ios_base::oct | ios_base::hex | ios_base::showpos ) )
+          != 0 || out.width() != 0
+       || !use_facet< numpunct<char> >(out.getloc()).grouping().empty() )
+   {
+      const char* sep = "";
+      for( int i = 0; i < used; ++i )
       {
-         if( data[i] == otherIntSet.data[i2] )
-            totUnionVals ++;
+         if( isLive(i) )
+         {
+            out << sep << data[i];
+            sep = "  ";
+         }
       }
+      return;
    }
 
-
-   // compute total # of vals needed in final union and resize if needed:
-
-   totUnionVals = ( used + otherIntSet.used ) - totUnionVals;
-
-   if( tempArray.capacity < totUnionVals ) 
-      tempArray.resize(totUnionVals);
-	
-   
-   // now insert the content from otherIntSet into tempArray, w/o dupes:
-
-   int otherUsed = otherIntSet.size();    // sentinel for outer loop
-
-   for( int i2 = 0; i2 < otherUsed; i2 ++ )
+   size_t bufSize = live * ( MAX_INT_CHARS + 2 );
+   if( bufSize > DUMP_CHUNK )
+      bufSize = DUMP_CHUNK;
+   vector<char> buf(bufSize);
+   char* p = &buf[0];
+   char* last = p + bufSize - ( MAX_INT_CHARS + 2 );   // room for 1 more
+   bool first = true;
+   for( int i = 0; i < used; ++i )
    {
-      for( int i = 0; i < tempArray.used; i ++ )
+      if( isLive(i) )
       {
-         if( otherIntSet.data[i2] == tempArray.data[i] )
+         if( p > last )
          {
-            tempFlag = true;              // flag the dupes 
+            out.write(&buf[0], static_cast<streamsize>( p - &buf[0] ));
+            p = &buf[0];
          }
+         if( !first )
+         {
+            *p ++ = ' ';
+            *p ++ = ' ';
+         }
+         first = false;
+         p = formatInt(p, data[i]);
       }
-
-      if( !tempFlag )                     // save non-dupes to tempArray
-      {	
-         tempArray.data[tempIndex] =      
-         otherIntSet.data[i2];	
-			
-         tempArray.used ++;               
-         tempIndex ++;                    
-                                          
-      }   
-		
-      tempFlag = false;                   // reset tempFlag for next pass
-                                        
-   }    
-          
-   return tempArray;   
+   }
+   out.write(&buf[0], static_cast<streamsize>( p - &buf[0] ));
 }
 
 // ========================================================================
 
-IntSet IntSet::intersect(const IntSet& otherIntSet) const
+size_t IntSet::DumpData(char* buf, size_t bufSize) const
 
-// this function creates a temporary IntSet object to collect
-// the intersection of relevant values from IntSet and otherIntSet;
-// any values not in the intersection are removed before 
-// returning the intersection to the calling function
+// this function formats straight into buf if it is big enough for the
+// longest possible text; otherwise it first works out the exact length
+// (so a buffer that is too small is left alone)
 {
-   IntSet tempArray(capacity);      // create a temp IntSet object 
-                                    // to hold the intersection vals
+   size_t live = size();
+   if( live == 0 )
+      return 0;
 
-   int strikeCount = 0;             // this var counts # times that
-                                    // a value in IntSet does not
-                                    // match a value in otherIntSet
-
-   for( int i = 0; i < used; i ++ ) // copy IntSet into tempArray
+   if( bufSize < live * ( MAX_INT_CHARS + 2 ) )
    {
-      tempArray.data[i] = data[i];
-      tempArray.used ++;
+      size_t need = 2 * ( live - 1 );
+      char digits[MAX_INT_CHARS];
+      for( int i = 0; i < used; ++i )
+         if( isLive(i) )
+            need += formatInt(digits, data[i]) - digits;
+      if( need > bufSize )
+         return need;
    }
-    
-   // now, remove the contents of tempArray if they're not contained
-   // in the intersection of thisIntSet and otherIntSet:
-	
-   for( int i = 0; i < used; i ++ )
+
+   char* p = buf;
+   for( int i = 0; i < used; ++i )
    {
-      for( int i2 = 0; i2 < otherIntSet.used; i2 ++ )
+      if( isLive(i) )
       {
-         if( data[i] != otherIntSet.data[i2] )
-            strikeCount ++;     
-      }
-
-         if( strikeCount == otherIntSet.size() )
+         if( p != buf )
          {
-            // if strikeCount == otherIntSet.size(), then the
-            // IntSet value was not found in otherIntSet, so
-            // it's not part of the intersection and should be
-            // removed. . . 
-			
-            assert ( tempArray.remove(data[i]) == true );
-            
-            strikeCount = 0;        // reset count for the next loop        
-         }    
-   }       
-   return tempArray;                // return the intersection values
+            *p ++ = ' ';
+            *p ++ = ' ';
+         }
+         p = formatInt(p, data[i]);
+      }
+   }
+   return static_cast<size_t>( p - buf );
 }
 
 // ========================================================================
 
-IntSet IntSet::subtract(const IntSet& otherIntSet) const
-
-// this function creates a temporary IntSet object to collect
-// only the unique elements among IntSet and otherIntSet (ie, the
-// dupes between the two sets are effectively removed from the
-// final collection by simply being ignored);
+void IntSet::DumpBinary(ostream& out) const
 {
-   // create temporary array object to hold val unique to this intSet
-
-   IntSet tempArray(capacity);		
-   bool tempFlag = false;           // the tempFlag marks dupes
-   int tempIndex = 0;               // var to track index of tempArray
+   unsigned int live = static_cast<unsigned int>( size() );
+   vector<unsigned char> buf(4 + 4 * static_cast<size_t>( live ));
 
-   for( int i = 0; i < used; i ++ )
+   unsigned char* p = &buf[0];
+   for( int b = 0; b < 4; b ++ )
+      *p ++ = static_cast<unsigned char>( live >> ( 8 * b ) );
+   for( int i = 0; i < used; ++i )
    {
-      for( int i2 = 0; i2 < otherIntSet.used; i2 ++ )
+      if( isLive(i) )
       {
-         if( data[i] == otherIntSet.data[i2] )
-         {
-            tempFlag = true;	    // use flag to mark dupes
-                                    // to be ignored in the 
-                                    // final collection
-         }
+         unsigned int u = static_cast<unsigned int>( data[i] );
+         for( int b = 0; b < 4; b ++ )
+            *p ++ = static_cast<unsigned char>( u >> ( 8 * b ) );
       }
+   }
+   out.write(reinterpret_cast<const char*>( &buf[0] ),
+             static_cast<streamsize>( buf.size() ));
+}
+
+// ========================================================================
+
+IntSet IntSet::unionWith(const IntSet& otherIntSet) const
+
+// this function creates a temporary IntSet object to collect the union of
+// relevant data values from IntSet and otherIntSet; the sequence 
+// of values is maintained while duplicates are removed; the dupes are
+// found by merging the two sorted views, which also tells exactly how
+// much capacity the union needs
+{
+   char* otherHit = new char[otherIntSet.used > 0 ? otherIntSet.used : 1]();
+
+   int totUnionVals = size() + otherIntSet.size()
+                      - matchSorted(otherIntSet, 0, otherHit);
 
-      // save each unique value to the tempArray:
-        
-      if( !tempFlag )				
+   IntSet tempArray( totUnionVals > capacity ? totUnionVals : capacity );
+
+   for( int i = 0; i < used; i ++ )       // copy IntSet values first,
+   {
+      if( isLive(i) )
+      {
+         tempArray.data[tempArray.used] = data[i];
+         tempArray.used ++;
+         tempArray.memberIn(data[i]);
+      }
+   }
+
+   for( int i2 = 0; i2 < otherIntSet.used; i2 ++ )
+   {
+      if( !otherHit[i2] && otherIntSet.isLive(i2) ) // then the non-dupes from
+      {                                   // otherIntSet, in their order
+         tempArray.data[tempArray.used] = otherIntSet.data[i2];
+         tempArray.used ++;
+         tempArray.memberIn(otherIntSet.data[i2]);
+      }
+   }
+
+   delete [] otherHit;
+   INTSET_COUNT(bytesCopied, tempArray.used * sizeof(int));
+   tempArray.syncIndex();                 // data was filled directly
+          
+   return tempArray;   
+}
+
+// ========================================================================
+
+IntSet IntSet::intersect(const IntSet& otherIntSet) const
+
+// this function creates a temporary IntSet object to collect
+// the intersection of relevant values from IntSet and otherIntSet;
+// the values of IntSet that the sorted-view merge found in otherIntSet
+// are copied over in their original order (nothing is removed, so
+// nothing has to be shifted)
+{
+   char* thisHit = new char[used > 0 ? used : 1]();
+   matchSorted(otherIntSet, thisHit, 0);
+
+   IntSet tempArray(capacity);      // create a temp IntSet object 
+                                    // to hold the intersection vals
+   for( int i = 0; i < used; i ++ )
+   {
+      if( thisHit[i] )
+      {
+         tempArray.data[tempArray.used] = data[i];
+         tempArray.used ++;
+         tempArray.memberIn(data[i]);
+      }
+   }
+
+   delete [] thisHit;
+   INTSET_COUNT(bytesCopied, tempArray.used * sizeof(int));
+   tempArray.syncIndex();           // data was filled directly
+   return tempArray;                // return the intersection values
+}
+
+// ========================================================================
+
+IntSet IntSet::subtract(const IntSet& otherIntSet) const
+
+// this function creates a temporary IntSet object to collect
+// only the unique elements among IntSet and otherIntSet (ie, the
+// dupes between the two sets, as flagged by the sorted-view merge,
+// are effectively removed from the final collection by simply being
+// ignored);
+{
+   char* thisHit = new char[used > 0 ? used : 1]();
+   matchSorted(otherIntSet, thisHit, 0);
+
+   IntSet tempArray(capacity);		
+   for( int i = 0; i < used; i ++ )
+   {
+      if( !thisHit[i] && isLive(i) ) // save each unique value
       {	
-         tempArray.data[tempIndex] = data[i];	
+         tempArray.data[tempArray.used] = data[i];	
          tempArray.used ++;         
-         tempIndex ++;
+         tempArray.memberIn(data[i]);
       }   
-	
-      
-      tempFlag = false;             // reset flag for next iteration:         
    }    
+
+   delete [] thisHit;
+   INTSET_COUNT(bytesCopied, tempArray.used * sizeof(int));
+   tempArray.syncIndex();           // data was filled directly
     
    return tempArray;                // return the IntSet obj
 }
@@ -433,9 +1198,21 @@ IntSet IntSet::subtract(const IntSet& otherIntSet) const
 void IntSet::reset()
 
 // this function simply resets the "used" member variable to 0 to indicate
-// that no relevant values exist in the class object
+// that no relevant values exist in the class object (the index, if any,
+// is released since an empty IntSet is below INDEX_THRESHOLD)
 {
    used = 0;                        
+   delete [] index;
+   index = 0;
+   indexSize = 0;
+   invalidateSorted();
+   holes = 0;                       // no places in use, so none dead
+   fpSum = 0;
+   fpXor = 0;
+   if( bloom )                      // start the filter over, small
+      rebuildBloom();
+   if( sketch )                     // and the sketch, empty
+      sketch->clear();
 }
 
 // ========================================================================
@@ -446,22 +1223,19 @@ bool IntSet::add(int anInt)
 // to see if it already exists in the subject object; if not, then 
 // the anInt value is appended to the tail of the data[] array;
 {
-   int nuCapacity = capacity;       // var to hold adjusted capacity
-
    if ( !contains(anInt) )          // make sure anInt isn't in the IntSet
    { 
-      if( (used + 1) > capacity )   // resize IntSet if it's full 	
-      {								
-         nuCapacity = capacity * 1.5;
-
-         if( nuCapacity == capacity )
-            nuCapacity ++;
-
-         resize(nuCapacity);
-      }
+      if( (used + 1) > capacity )   // resize IntSet if it's full, as
+         resize(grownCapacity(used + 1));   // the growth policy says
 
       data[used] = anInt;           // if anInt doesn't exist in the intSet,
-      used ++;                      // then add it to the end of the intSet
+      if( dead )                    // then add it to the end of the intSet
+         dead[used] = 0;
+      used ++;
+      indexInsert(used - 1);        // (and index it)
+      memberIn(anInt);
+      invalidateSorted();
+      summaryUpkeep();
 
       return true;                  // and return true.
    }
@@ -473,62 +1247,819 @@ bool IntSet::add(int anInt)
 
 bool IntSet::remove(int anInt)
 
-// this function first uses the contains() method to check if the anInt
-// parameter exists in the object's data[] array; 
-// if not, it returns false;
-// if so, then it iterates thru the data[] array until if finds the 
-// index of the target value; once the index is found, the following 
-// logic applies:
+// this function first checks if the anInt parameter exists in the
+// object's data[] array (via the index if there is one, otherwise by
+// iterating thru the data[] array until it finds the index of the
+// target value); if not, it returns false;
+// if so, then the following logic applies:
 // *   if the index is the ultimate value in the array, then 
 //     simply decrement the "used" member variable and return true;
 // *   if the index is between indices [0] and [ultimate] inclusive,
 //     then decrement the "used" member variable and overwrite the  
 //     index by shifting all trailing elements leftward by one index
+//     (and, if there is an index, renumber the shifted positions)
 {
-   if( contains(anInt) )                   
+   int pos = -1;                        // position of anInt in data[]
+
+   if( indexSize > 0 )
+   {
+      int slot = findSlot(anInt);
+      if( index[slot] == -1 )
+         return false;                  // anInt isn't in the intSet
+
+      pos = index[slot];
+      indexErase(slot);
+      memberOut(anInt);
+
+      if( deadRatio > 0 )               // TOMBSTONE mode: mark the place
+      {                                 // dead instead of closing it up
+         if( !dead )
+            dead = new char[capacity]();
+         dead[pos] = 1;
+         holes ++;
+         invalidateSorted();
+
+         if( holes > deadRatio * used )
+            compact();
+         summaryUpkeep();
+         return true;
+      }
+   }
+   else
    {
-      for( int i = 0; i < used; i ++ )    
+      pos = findInt(data, used, anInt); // find the index of anInt 
+      INTSET_COUNT(comparisons, ( pos == -1 ) ? used : pos + 1);
+      if( pos == -1 )
+         return false;                  // anInt isn't in the intSet
+      memberOut(anInt);
+   }
+
+   // make a hole at anInt index and backfill by shifting all trailing
+   // elements leftward (nothing to shift if index is [ultimate]):
+
+   for( int i = pos; i < used - 1; i ++ ) 
+   {
+      data[i] = data[i + 1];	
+   }
+   INTSET_COUNT(moves, used - 1 - pos);
+   used --;                   
+   invalidateSorted();
+
+   // each shifted value's slot still holds its old position (one more
+   // than its new one): if only a few values were shifted, walk each
+   // one's probe sequence to its slot and fix it, otherwise it's cheaper
+   // to sweep the whole index once and decrement every stale position
+
+   if( indexSize > 0 )
+   {
+      if( 16 * ( used - pos ) < indexSize )
       {
-         if( data[i] == anInt )         // find the index of anInt 
+         int mask = indexSize - 1;
+         for( int i = pos; i < used; i ++ )
          {
-            if( i == ( used - 1 ) )     // if index is [ultimate]
-            {
-               used --;                 // then decrement "used" 
-               return true;             // and return true;
-            }   
-            else                        
-            {
-               // else, make a hole at anInt index and backfill by
-               // shifting all trailing elements leftward:
-                	
-               for( int i2 = i; i2 < used; i2 ++ ) 
-               {
-                  data[i2] = data[i2 + 1];	
-               }
-
-               used --;                   
-               return true;            
-            }
+            int slot = homeSlot(data[i], mask);
+            while( index[slot] != i + 1 )
+               slot = ( slot + 1 ) & mask;
+            index[slot] = i;
          }
       }
+      else
+      {
+         for( int s = 0; s < indexSize; s ++ )
+            index[s] -= ( index[s] > pos );   // (branch-free on purpose)
+      }
    }
-									
-   return false;                        // return false if intSet  
-                                        // doesn't contain anInt
+
+   summaryUpkeep();
+   return true;            
 }
 
 // ========================================================================
 
-bool operator==(const IntSet& is1, const IntSet& is2)
+bool IntSet::isLive(int pos) const
+{
+   return ( holes == 0 || !dead[pos] );
+}
+
+// ========================================================================
+
+void IntSet::memberIn(int anInt)
+{
+   unsigned int h = fingerprintOf(anInt);
+   fpSum += h;
+   fpXor ^= h;
+   if( bloom )
+      bloom->insert(anInt);
+   if( sketch )
+      sketch->insert(anInt);
+}
+
+// ========================================================================
+
+void IntSet::memberOut(int anInt)
+{
+   unsigned int h = fingerprintOf(anInt);
+   fpSum -= h;
+   fpXor ^= h;
+   if( bloom )
+      bloom->noteRemoval();
+   if( sketch )
+      sketch->noteRemoval();
+}
 
-// this function checks to see if is1 == is2 by confirming if:
-// *   each object's elements are subsets of one another
-// *   each object's data[] array contains the same # elements
+// ========================================================================
+
+void IntSet::summaryUpkeep()
 {
-   if ( is1.size() == is2.size() &&      
-        is1.isSubsetOf(is2) &&     
-        is2.isSubsetOf(is1) )
-      return true;                    
+   if( bloom && bloom->needsRebuild(size()) )
+      rebuildBloom();
+   if( sketch && sketch->needsRebuild(size()) )
+      rebuildSketch();
+}
+
+// ========================================================================
+
+void IntSet::rebuildBloom()
+
+// this function sizes the filter with room to double (so a growing
+// IntSet rebuilds it only O(log n) times) and refills it
+{
+   bloom->build(2 * size());
+   for( int i = 0; i < used; i ++ )
+   {
+      if( isLive(i) )
+         bloom->insert(data[i]);
+   }
+}
+
+// ========================================================================
+
+void IntSet::setBloomFilter(double falsePositiveRate, int maxBytes)
+{
+   delete bloom;
+   bloom = new IntBloomFilter(falsePositiveRate, maxBytes);
+   rebuildBloom();
+}
+
+// ========================================================================
+
+void IntSet::dropBloomFilter()
+{
+   delete bloom;
+   bloom = 0;
+}
+
+// ========================================================================
+
+int IntSet::bloomFilterBytes() const
+{
+   return bloom ? bloom->bytes() : 0;
+}
+
+// ========================================================================
+
+double IntSet::bloomFilterRate() const
+{
+   return bloom ? bloom->estimatedRate() : 0;
+}
+
+// ========================================================================
+
+void IntSet::rebuildSketch()
+{
+   sketch->clear();
+   for( int i = 0; i < used; i ++ )
+   {
+      if( isLive(i) )
+         sketch->insert(data[i]);
+   }
+}
+
+// ========================================================================
+
+void IntSet::setSketch(int precision, int minHashes)
+{
+   delete sketch;
+   sketch = new IntSetSketch(precision, minHashes);
+   rebuildSketch();
+}
+
+// ========================================================================
+
+void IntSet::dropSketch()
+{
+   delete sketch;
+   sketch = 0;
+}
+
+// ========================================================================
+
+const IntSetSketch* IntSet::getSketch() const
+{
+   return sketch;
+}
+
+// ========================================================================
+
+int IntSet::countCommon(const IntSet& otherIntSet) const
+{
+   int common = 0;
+   for( int i = 0; i < used; i ++ )
+   {
+      if( isLive(i) && otherIntSet.contains(data[i]) )
+         common ++;
+   }
+   return common;
+}
+
+// ========================================================================
+
+double IntSet::estimateUnionSize(const IntSet& otherIntSet) const
+
+// this function answers from the sketches if both IntSet's have
+// compatible ones, otherwise it counts the union exactly
+{
+   if( sketch && otherIntSet.sketch && sketch->compatible(*otherIntSet.sketch) )
+      return sketch->unionCardinality(*otherIntSet.sketch);
+
+   return size() + otherIntSet.size() - countCommon(otherIntSet);
+}
+
+// ========================================================================
+
+double IntSet::estimateJaccard(const IntSet& otherIntSet) const
+
+// this function answers from the sketches if both IntSet's have
+// compatible ones, otherwise it works out the similarity exactly
+{
+   if( sketch && otherIntSet.sketch && sketch->compatible(*otherIntSet.sketch) )
+      return sketch->jaccard(*otherIntSet.sketch);
+
+   int common = countCommon(otherIntSet);
+   int unionSize = size() + otherIntSet.size() - common;
+   return ( unionSize == 0 ) ? 1 : static_cast<double>(common) / unionSize;
+}
+
+// ========================================================================
+
+void IntSet::setRemoveMode(RemoveMode mode, double maxDeadRatio)
+
+// this function records the mode as the dead-place ratio that triggers
+// compaction (0 meaning SHIFT); dead places are squeezed out right away
+// when going back to SHIFT, since SHIFT mode has none
+{
+   if( mode == TOMBSTONE )
+      deadRatio = maxDeadRatio;
    else
-      return false;              
-}
\ No newline at end of file
+   {
+      compact();
+      deadRatio = 0;
+   }
+}
+
+// ========================================================================
+
+void IntSet::compact()
+
+// this function slides every live value down over the dead places (a
+// single pass) and re-indexes, since positions have changed
+{
+   if( holes == 0 )
+      return;
+
+   int kept = 0;
+   for( int i = 0; i < used; i ++ )
+   {
+      if( !dead[i] )
+      {
+         data[kept] = data[i];
+         INTSET_COUNT(moves, kept != i);
+         kept ++;
+      }
+   }
+   for( int i = 0; i < used; i ++ )
+      dead[i] = 0;
+
+   used = kept;
+   holes = 0;
+   invalidateSorted();
+   buildIndex(indexSizeFor(used));
+}
+
+// ========================================================================
+
+void IntSet::setGrowthPolicy(const GrowthPolicy& policy)
+{
+   growth = policy;
+   if( growth.factor < 1 )
+      growth.factor = 1;
+   if( growth.minStep < 1 )
+      growth.minStep = 1;
+}
+
+// ========================================================================
+
+void IntSet::reserve(int n)
+
+// this function grows the array (only) to exactly n places, and if n
+// values would need an index, sizes the index for them as well, so
+// that n values can then be added without any reallocation
+{
+   if( n > capacity )
+      resize(n);
+
+   if( n >= INDEX_THRESHOLD && indexSize < 2 * n )
+      buildIndex(indexSizeFor(n));
+}
+
+// ========================================================================
+
+void IntSet::shrink_to_fit()
+
+// this function squeezes out any dead places, then reallocates the
+// array to exactly the # of values (and the index, if it is larger than
+// a fresh one would be), and frees the sorted view
+{
+   compact();
+
+   if( capacity > used && used > 0 )
+      resize(used);
+
+   if( indexSize > 0 )
+   {
+      if( used < INDEX_THRESHOLD )
+      {
+         delete [] index;
+         index = 0;
+         indexSize = 0;
+      }
+      else if( indexSize > indexSizeFor(used) )
+         buildIndex(indexSizeFor(used));
+   }
+
+   delete [] sorted;
+   sorted = 0;
+   sortedValid = false;
+}
+
+// ========================================================================
+
+int IntSet::currentCapacity() const
+{
+   return capacity;
+}
+
+// ========================================================================
+
+const IntSet::AllocStats& IntSet::allocStats() const
+{
+   return stats;
+}
+
+// ========================================================================
+
+void IntSet::resetAllocStats()
+{
+   stats = AllocStats();
+   stats.peakCapacity = capacity;
+}
+
+// ========================================================================
+
+#ifdef INTSET_STATS
+IntSetCounters IntSet::globalCounters;
+
+static IntSet::OpStats readCounters(const IntSetCounters& counters)
+
+// this function takes a snapshot of counters (each one read atomically,
+// though not all at the same instant)
+{
+   IntSet::OpStats result;
+   result.comparisons = counters.comparisons.load(memory_order_relaxed);
+   result.moves = counters.moves.load(memory_order_relaxed);
+   result.reallocations = counters.reallocations.load(memory_order_relaxed);
+   result.bytesCopied = counters.bytesCopied.load(memory_order_relaxed);
+   return result;
+}
+
+static void clearCounters(IntSetCounters& counters)
+{
+   counters.comparisons.store(0, memory_order_relaxed);
+   counters.moves.store(0, memory_order_relaxed);
+   counters.reallocations.store(0, memory_order_relaxed);
+   counters.bytesCopied.store(0, memory_order_relaxed);
+}
+#endif
+
+// ========================================================================
+
+IntSet::OpStats IntSet::opStats() const
+{
+#ifdef INTSET_STATS
+   return readCounters(opCounters);
+#else
+   return OpStats();
+#endif
+}
+
+// ========================================================================
+
+void IntSet::resetOpStats()
+{
+#ifdef INTSET_STATS
+   clearCounters(opCounters);
+#endif
+}
+
+// ========================================================================
+
+IntSet::OpStats IntSet::globalOpStats()
+{
+#ifdef INTSET_STATS
+   return readCounters(globalCounters);
+#else
+   return OpStats();
+#endif
+}
+
+// ========================================================================
+
+void IntSet::resetGlobalOpStats()
+{
+#ifdef INTSET_STATS
+   clearCounters(globalCounters);
+#endif
+}
+
+// ========================================================================
+
+bool IntSet::opStatsEnabled()
+{
+#ifdef INTSET_STATS
+   return true;
+#else
+   return false;
+#endif
+}
+
+// ========================================================================
+
+int IntSet::addAll(const int* first, const int* last)
+
+// this function makes room for the whole range at once (capacity and,
+// if the result may be big enough to need one, an index with room for
+// every value), then appends each value the index hasn't seen yet; the
+// index catches repeats within the range as well as existing members
+{
+   int numVals = static_cast<int>(last - first);
+   int added = 0;
+
+   if( numVals <= 0 )
+      return 0;
+
+   if( used + numVals > capacity )
+      resize(grownCapacity(used + numVals));
+
+   if( used + numVals < INDEX_THRESHOLD )   // small: plain add() is fine
+   {
+      for( const int* p = first; p != last; ++ p )
+         if( add(*p) )
+            added ++;
+      return added;
+   }
+
+   if( indexSize < 2 * ( used + numVals ) )
+      buildIndex(indexSizeFor(used + numVals));
+
+   for( const int* p = first; p != last; ++ p )
+   {
+      int slot = findSlot(*p);
+      if( index[slot] == -1 )
+      {
+         data[used] = *p;
+         if( dead )
+            dead[used] = 0;
+         index[slot] = used;
+         used ++;
+         added ++;
+         memberIn(*p);
+      }
+   }
+
+   if( added > 0 )
+      invalidateSorted();
+   summaryUpkeep();
+
+   return added;
+}
+
+// ========================================================================
+
+void IntSet::keepFlagged(const char* hit, char keep)
+
+// this function slides the values to keep down over the ones dropped (a
+// single pass, nothing shifted more than once) and then re-indexes
+{
+   int kept = 0;
+   for( int i = 0; i < used; i ++ )
+   {
+      if( hit[i] == keep && isLive(i) )
+      {
+         data[kept] = data[i];
+         INTSET_COUNT(moves, kept != i);
+         if( dead )
+            dead[kept] = 0;
+         kept ++;
+      }
+      else if( isLive(i) )
+         memberOut(data[i]);
+   }
+
+   if( kept == used )               // nothing was dropped
+      return;
+
+   used = kept;
+   holes = 0;
+   invalidateSorted();
+
+   delete [] index;                 // positions have changed
+   index = 0;
+   indexSize = 0;
+   syncIndex();
+   summaryUpkeep();
+}
+
+// ========================================================================
+
+IntSet& IntSet::operator|=(const IntSet& otherIntSet)
+
+// this function appends the values of otherIntSet that the sorted-view
+// merge didn't find in "this", growing the array at most once
+{
+   char* otherHit = new char[otherIntSet.used > 0 ? otherIntSet.used : 1]();
+
+   int newVals = otherIntSet.size()
+                 - matchSorted(otherIntSet, 0, otherHit);
+
+   if( newVals > 0 )
+   {
+      if( used + newVals > capacity )
+         resize(grownCapacity(used + newVals));
+
+      for( int i2 = 0; i2 < otherIntSet.used; i2 ++ )
+      {
+         if( !otherHit[i2] && otherIntSet.isLive(i2) )
+         {
+            data[used] = otherIntSet.data[i2];
+            if( dead )
+               dead[used] = 0;
+            used ++;
+            indexInsert(used - 1);
+            memberIn(otherIntSet.data[i2]);
+         }
+      }
+      invalidateSorted();
+      summaryUpkeep();
+   }
+
+   delete [] otherHit;
+   return *this;
+}
+
+// ========================================================================
+
+IntSet& IntSet::operator&=(const IntSet& otherIntSet)
+
+// this function keeps only the values also found in otherIntSet
+{
+   char* thisHit = new char[used > 0 ? used : 1]();
+   matchSorted(otherIntSet, thisHit, 0);
+   keepFlagged(thisHit, 1);
+   delete [] thisHit;
+
+   return *this;
+}
+
+// ========================================================================
+
+IntSet& IntSet::operator-=(const IntSet& otherIntSet)
+
+// this function keeps only the values not found in otherIntSet
+{
+   char* thisHit = new char[used > 0 ? used : 1]();
+   matchSorted(otherIntSet, thisHit, 0);
+   keepFlagged(thisHit, 0);
+   delete [] thisHit;
+
+   return *this;
+}
+
+// ========================================================================
+
+IntSet::const_iterator IntSet::begin() const
+
+// this function hands out an iterator that steps over dead places
+// (only if there are any, so the common case is a bare pointer walk)
+{
+   return const_iterator(data, data + used, holes > 0 ? dead : 0);
+}
+
+// ========================================================================
+
+IntSet::const_iterator IntSet::end() const
+{
+   return const_iterator(data + used, data + used, 0);
+}
+
+// ========================================================================
+
+IntSet::View IntSet::view()
+{
+   compact();                        // (nothing to do without holes)
+
+   View v;
+   v.first = data;
+   v.count = used;
+   return v;
+}
+
+// ========================================================================
+
+IntSet IntSet::unionAll(const vector<const IntSet*>& sets)
+
+// this function merges the sorted views of all the IntSets with a heap
+// of one cursor per IntSet; among equal values the cursor of the
+// lowest-numbered IntSet pops first, so each distinct value is flagged
+// at its first occurrence, and the flagged values are then copied set
+// by set in membership order
+{
+   struct Cursor
+   {
+      int value;
+      int set;
+      int i;
+      bool operator>(const Cursor& rhs) const
+      {
+         return ( value != rhs.value ) ? ( value > rhs.value )
+                                       : ( set > rhs.set );
+      }
+   };
+
+   int k = static_cast<int>( sets.size() );
+   vector< vector<char> > first(k);
+   priority_queue< Cursor, vector<Cursor>, greater<Cursor> > heap;
+
+   for( int s = 0; s < k; s ++ )
+   {
+      first[s].assign(sets[s]->used, 0);
+      if( !sets[s]->isEmpty() )
+      {
+         Cursor c = { sets[s]->sortedView()[0].value, s, 0 };
+         heap.push(c);
+      }
+   }
+
+   int total = 0;
+   bool any = false;
+   int last = 0;
+   while( !heap.empty() )
+   {
+      Cursor c = heap.top();
+      heap.pop();
+
+      const Entry* view = sets[c.set]->sortedView();
+      if( !any || c.value != last )        // first time this value is seen
+      {
+         first[c.set][view[c.i].pos] = 1;
+         total ++;
+         any = true;
+         last = c.value;
+      }
+
+      if( ++ c.i < sets[c.set]->size() )
+      {
+         c.value = view[c.i].value;
+         heap.push(c);
+      }
+   }
+
+   IntSet result( total > 0 ? total : DEFAULT_CAPACITY );
+   for( int s = 0; s < k; s ++ )
+   {
+      const IntSet& src = *sets[s];
+      for( int i = 0; i < src.used; i ++ )
+      {
+         if( first[s][i] )
+         {
+            result.data[result.used] = src.data[i];
+            result.used ++;
+            result.memberIn(src.data[i]);
+         }
+      }
+   }
+   INTSET_COUNT_IN(result, bytesCopied, result.used * sizeof(int));
+   result.syncIndex();                  // data was filled directly
+
+   return result;
+}
+
+// ========================================================================
+
+IntSet IntSet::intersectAll(const vector<const IntSet*>& sets)
+
+// this function takes the values of the smallest IntSet as candidates,
+// strikes out each one some other IntSet (tried in order of size) lacks,
+// and then copies the survivors in the membership order of *sets[0]
+{
+   int k = static_cast<int>( sets.size() );
+   if( k == 0 )
+      return IntSet();
+
+   vector<int> bySize(k);
+   for( int s = 0; s < k; s ++ )
+      bySize[s] = s;
+   stable_sort(bySize.begin(), bySize.end(),
+               [&sets](int a, int b) { return sets[a]->size() < sets[b]->size(); });
+
+   const IntSet& smallest = *sets[bySize[0]];
+   vector<int> candidates;
+   candidates.reserve(smallest.size());
+   for( int i = 0; i < smallest.used; i ++ )
+   {
+      if( smallest.isLive(i) )
+         candidates.push_back(smallest.data[i]);
+   }
+
+   for( int r = 1; r < k && !candidates.empty(); r ++ )
+   {
+      const IntSet& other = *sets[bySize[r]];
+      int kept = 0;
+      for( size_t c = 0; c < candidates.size(); c ++ )
+      {
+         if( other.contains(candidates[c]) )
+            candidates[kept ++] = candidates[c];
+      }
+      candidates.resize(kept);
+   }
+
+   const IntSet& order = *sets[0];
+   int total = static_cast<int>( candidates.size() );
+   IntSet result( total > 0 ? total : DEFAULT_CAPACITY );
+
+   if( bySize[0] == 0 )                   // already in *sets[0]'s order
+   {
+      for( int c = 0; c < total; c ++ )
+      {
+         result.data[c] = candidates[c];
+         result.memberIn(candidates[c]);
+      }
+      result.used = total;
+   }
+   else if( total > 0 )                   // flag them in *sets[0]
+   {
+      vector<char> hit(order.used, 0);
+      for( int c = 0; c < total; c ++ )
+      {
+         int pos = ( order.indexSize > 0 )
+                   ? order.index[order.findSlot(candidates[c])]
+                   : findInt(order.data, order.used, candidates[c]);
+         hit[pos] = 1;
+      }
+      for( int i = 0; i < order.used; i ++ )
+      {
+         if( hit[i] )
+         {
+            result.data[result.used] = order.data[i];
+            result.used ++;
+            result.memberIn(order.data[i]);
+         }
+      }
+   }
+   INTSET_COUNT_IN(result, bytesCopied, result.used * sizeof(int));
+   result.syncIndex();                    // data was filled directly
+
+   return result;
+}
+
+// ========================================================================
+
+bool operator==(const IntSet& is1, const IntSet& is2)
+
+// this function checks to see if is1 == is2 by confirming that:
+// *   each object has the same # of elements and the same fingerprint
+//     (if not, they can't be equal, and that takes only O(1) to see)
+// *   every element of is1 is also an element of is2 (with equal sizes
+//     this makes them subsets of one another), looked up in is2's
+//     index if it has one (so this takes expected O(n) time)
+{
+   if( is1.size() != is2.size() ||
+       is1.fpSum != is2.fpSum || is1.fpXor != is2.fpXor )
+      return false;
+
+   for( int i = 0; i < is1.used; i ++ )
+   {
+      if( is1.isLive(i) && !is2.contains(is1.data[i]) )
+         return false;
+   }
+   return true;
+}
@@ -20,6 +20,48 @@
 //     Note: When the IntSet is put to use after construction,
 //           its capacity will be resized as necessary.
 //
+// TYPES
+//   enum RemoveMode { SHIFT, TOMBSTONE }
+//     IntSet::RemoveMode tells how remove() deals with the hole a
+//     removed value leaves behind (see setRemoveMode).
+//   struct GrowthPolicy
+//     IntSet::GrowthPolicy tells how much the capacity grows when the
+//     IntSet is full: to capacity * factor, but by at least minStep,
+//     and (if pageBytes > 0) rounded up to a whole # of pageBytes
+//     bytes (e.g. 4096 to fill memory pages).
+//     GrowthPolicy(double factor = 1.5, int minStep = 8,
+//                  int pageBytes = 0) sets the three members.
+//   struct AllocStats
+//     IntSet::AllocStats counts, for one IntSet:
+//       allocations  - # of times its data array was (re)allocated
+//       intsCopied   - # of values copied by those reallocations
+//       indexBuilds  - # of times its hash index was (re)built
+//       peakCapacity - the largest capacity it has had
+//   struct OpStats
+//     IntSet::OpStats counts the work done by IntSet operations (only
+//     if compiled with INTSET_STATS defined; see IntSetStats.h):
+//       comparisons   - # of values compared: index probes, values
+//                       examined by scans, and the steps of sorting and
+//                       merging sorted views
+//       moves         - # of values moved within the data array (the
+//                       shifts of remove, the squeezing of dead places)
+//       reallocations - # of times the data array was reallocated to
+//                       grow or shrink it (by resize)
+//       bytesCopied   - # of bytes copied from one array to another
+//                       (reallocations, copies of an IntSet, and the
+//                       results of the set operations)
+//   class const_iterator
+//     IntSet::const_iterator is a forward iterator over the elements
+//     of an IntSet in membership order, yielding const int&'s
+//     straight from the IntSet's array (no copy is made).
+//   struct View
+//     IntSet::View is a read-only view of the elements of an IntSet
+//     as one contiguous array, in membership order: it has
+//     const int* data() const, int size() const,
+//     const int& operator[](int i) const, and begin() / end() (as
+//     const int*'s), so it may be used in range-based for loops or
+//     handed to code that takes a pointer and a length.
+//
 // CONSTANT MEMBER FUNCTIONS (ACCESSORS)
 //   int size() const
 //     Pre:  (none)
@@ -45,6 +87,26 @@
 //     Post: Contents of the invoking IntSet have been inserted into
 //           out with 2 spaces separating one item from another if
 //           if there are 2 or more items.
+//     Note: With out's default format (decimal, no showpos, width 0
+//           and no digit grouping), the values are formatted into a
+//           buffer of at most 64 KiB and written a buffer-full at a
+//           time; with any other format they are inserted one by one,
+//           so the format applies as it would to << (the width to the
+//           first insertion only).
+//   std::size_t DumpData(char* buf, std::size_t bufSize) const
+//     Pre:  buf has room for bufSize chars (buf may be 0 if bufSize is
+//           0).
+//     Post: The # of chars of the text DumpData(out) would insert
+//           with out's default format is returned; if it is <=
+//           bufSize, buf holds that text (with no terminating '\0'),
+//           otherwise buf is unchanged.
+//   void DumpBinary(std::ostream& out) const
+//     Pre:  (none)
+//     Post: The contents of the invoking IntSet have been inserted into
+//           out with a single write, in binary: the # of items as an
+//           unsigned 32-bit integer, then the items in the order
+//           DumpData gives them, each as a signed 32-bit integer (all
+//           little-endian, 4 + 4 * size() bytes in all).
 //   IntSet unionWith(const IntSet& otherIntSet) const
 //     Pre:  (none)
 //     Post: An IntSet representing the union of the invoking IntSet
@@ -87,6 +149,225 @@
 //           removed from the invoking IntSet and true is
 //           returned, otherwise the invoking IntSet is unchanged
 //           and false is returned.
+//   int addAll(const int* first, const int* last)
+//   template <class InputIterator>
+//   int addAll(InputIterator first, InputIterator last)
+//     Pre:  [first, last) is a valid range of int values.
+//     Post: Every value in [first, last) has been added to the
+//           invoking IntSet as by add() (so the new values become
+//           members in the order they are first seen, and values
+//           already present or repeated are ignored), and the # of
+//           new elements is returned.
+//     Note: The capacity (and the hash index, for a large result) is
+//           grown once up front for the whole range, so there are no
+//           repeated reallocations, and each value is checked in
+//           expected O(1) time; the capacity may end up larger than
+//           needed if the range holds many repeats.
+//   void setRemoveMode(RemoveMode mode, double maxDeadRatio = 0.25)
+//     Pre:  0 < maxDeadRatio < 1 (only used if mode is TOMBSTONE)
+//     Post: remove() will work in the given mode from now on:
+//           SHIFT     - (the default) the values after the removed
+//                       one are shifted left to close the hole at once
+//           TOMBSTONE - the removed value's place is just marked dead
+//                       (expected O(1)), and the dead places are
+//                       squeezed out (as by compact) when they exceed
+//                       maxDeadRatio of the places in use
+//           In either mode, size() and the membership order are
+//           exactly as if every hole had been closed at once.
+//     Note: Small IntSets (without a hash index) always SHIFT, since
+//           that is as cheap as marking for them. Switching to SHIFT
+//           compacts the invoking IntSet.
+//   void compact()
+//     Pre:  (none)
+//     Post: Any places marked dead by TOMBSTONE removals have been
+//           squeezed out (the collection itself is unchanged).
+//   void setGrowthPolicy(const GrowthPolicy& policy)
+//     Pre:  (none)
+//     Post: The invoking IntSet grows by policy from now on (a factor
+//           below 1 counts as 1 and a minStep below 1 as 1).
+//     Note: The default policy is GrowthPolicy(), i.e. 1.5x but at
+//           least 8 more; copies get the policy of their source.
+//   void reserve(int n)
+//     Pre:  (none)
+//     Post: The capacity is at least n (and if n values need a hash
+//           index, the index has room for n values), so the IntSet
+//           can hold n values without reallocating anything.
+//   void shrink_to_fit()
+//     Pre:  (none)
+//     Post: Dead places have been squeezed out, the capacity is the
+//           # of values (1 if empty), the hash index (if any) is no
+//           bigger than a freshly built one, and the sorted view has
+//           been freed; the collection itself is unchanged.
+//   int currentCapacity() const
+//     Pre:  (none)
+//     Post: The capacity of the invoking IntSet is returned.
+//   const AllocStats& allocStats() const
+//     Pre:  (none)
+//     Post: The allocation statistics of the invoking IntSet since it
+//           was made (or last reset) are returned.
+//   void resetAllocStats()
+//     Pre:  (none)
+//     Post: The allocation statistics are back to 0 (peakCapacity to
+//           the current capacity).
+//     Note: currentCapacity and allocStats are accessors, listed here
+//           to keep the memory functions together.
+//   OpStats opStats() const
+//     Pre:  (none)
+//     Post: The work counted for the operations on the invoking IntSet
+//           (as the invoking IntSet, or as the argument of a set
+//           operation that it answered lookups for) since it was made
+//           or last reset is returned; all 0 if opStatsEnabled() is
+//           false. A copy of an IntSet starts from 0.
+//   void resetOpStats()
+//     Pre:  (none)
+//     Post: The invoking IntSet's OpStats are back to 0.
+//   static OpStats globalOpStats()
+//   static void resetGlobalOpStats()
+//     Pre:  (none)
+//     Post: As opStats and resetOpStats, for the work of all IntSet's
+//           of the program together.
+//   static bool opStatsEnabled()
+//     Pre:  (none)
+//     Post: True is returned if the program was compiled with
+//           INTSET_STATS defined (so work is counted), otherwise false.
+//     Note: Without INTSET_STATS, the counting compiles to nothing.
+//   void setBloomFilter(double falsePositiveRate = 0.01, int maxBytes = 0)
+//     Pre:  0 < falsePositiveRate < 1; maxBytes >= 0
+//     Post: The invoking IntSet has a Bloom filter (see IntSetBloom.h)
+//           in front of contains(), sized for falsePositiveRate and
+//           using at most maxBytes bytes (no limit if 0), replacing
+//           any filter it had: most lookups of non-members are then
+//           answered from the filter alone, without touching data.
+//     Note: The filter is kept up to date by every change; it is
+//           rebuilt (O(n)) when the IntSet outgrows it or when a
+//           quarter of the values it holds have been removed. A
+//           maxBytes too small for the IntSet raises the real rate.
+//   void dropBloomFilter()
+//     Pre:  (none)
+//     Post: The invoking IntSet has no Bloom filter.
+//   int bloomFilterBytes() const
+//   double bloomFilterRate() const
+//     Pre:  (none)
+//     Post: The memory used by the Bloom filter and its expected
+//           false-positive rate at present are returned (0 and 0 if
+//           the invoking IntSet has no filter).
+//     Note: These are accessors, listed here to keep the filter's
+//           functions together.
+//   void setSketch(int precision = 12, int minHashes = 256)
+//     Pre:  4 <= precision <= 18; minHashes >= 1
+//     Post: The invoking IntSet has a HyperLogLog and MinHash sketch
+//           of its values (see IntSetSketch.h) with the given
+//           parameters, replacing any sketch it had, so that
+//           estimateUnionSize and estimateJaccard with another
+//           IntSet that has a sketch with the same parameters take
+//           O(2^precision + minHashes) time, however big the sets.
+//     Note: The sketch is kept up to date by every change (in O(1)
+//           for most values added); since a sketch can't forget a
+//           value, it is rebuilt (O(n)) once a quarter of the values
+//           in it have been removed.
+//   void dropSketch()
+//     Pre:  (none)
+//     Post: The invoking IntSet has no sketch.
+//   const IntSetSketch* getSketch() const
+//     Pre:  (none)
+//     Post: The invoking IntSet's sketch is returned (0 if it has
+//           none), e.g. to merge the sketches of many IntSet's.
+//   double estimateUnionSize(const IntSet& otherIntSet) const
+//   double estimateJaccard(const IntSet& otherIntSet) const
+//     Pre:  (none)
+//     Post: The # of values in the union of the invoking IntSet and
+//           otherIntSet, or their Jaccard similarity (the size of
+//           their intersection over that of their union, 1 if both
+//           are empty), is returned: estimated from the sketches if
+//           both have sketches with the same parameters, otherwise
+//           worked out exactly in O(n) (without building the union
+//           or the intersection).
+//     Note: The last three are accessors, listed here to keep the
+//           sketch's functions together.
+//   IntSet& operator|=(const IntSet& otherIntSet)
+//     Pre:  (none)
+//     Post: All elements of otherIntSet have been added to the
+//           invoking IntSet (those that are new in the order they
+//           have in otherIntSet) and the invoking IntSet is
+//           returned; i.e., the invoking IntSet has become what
+//           unionWith(otherIntSet) would return, but without any
+//           temporary IntSet being created.
+//   IntSet& operator&=(const IntSet& otherIntSet)
+//     Pre:  (none)
+//     Post: All elements of the invoking IntSet that are not also
+//           elements of otherIntSet have been removed from it and
+//           the invoking IntSet is returned (i.e., it has become
+//           what intersect(otherIntSet) would return).
+//   IntSet& operator-=(const IntSet& otherIntSet)
+//     Pre:  (none)
+//     Post: All elements of otherIntSet have been removed from the
+//           invoking IntSet and the invoking IntSet is returned (i.e.,
+//           it has become what subtract(otherIntSet) would return).
+//
+// ITERATION (ZERO-COPY ACCESS TO THE ELEMENTS)
+//   const_iterator begin() const
+//   const_iterator end() const
+//     Pre:  (none)
+//     Post: Iterators to the first element and past the last element
+//           (in membership order) are returned, so that [begin(),
+//           end()) holds every element exactly once.
+//     Note: Any change to the IntSet invalidates its iterators.
+//   View view()
+//     Pre:  (none)
+//     Post: A View of the elements of the invoking IntSet is
+//           returned; it stays valid until the IntSet is next changed.
+//     Note: A View needs the elements to be contiguous, so places
+//           left dead by TOMBSTONE removals are squeezed out first
+//           (as by compact; the collection itself is unchanged); this
+//           is why view() isn't const. Otherwise it takes O(1) time.
+//
+// STATIC MEMBER FUNCTIONS (N-WAY SET ALGEBRA)
+//   static IntSet unionAll(const std::vector<const IntSet*>& sets)
+//     Pre:  Each element of sets references a valid IntSet.
+//     Post: The union of all the IntSet's in sets is returned, with
+//           its elements in the order chained unionWith calls would
+//           give (those of *sets[0] first, then the new ones of
+//           *sets[1], and so on); an empty IntSet is returned if sets
+//           is empty.
+//     Note: The sorted views of all the IntSet's are merged at once
+//           (a k-way merge, O(N log k) for N values in k IntSet's),
+//           and the result is built directly: no IntSet is made along
+//           the way.
+//   static IntSet intersectAll(const std::vector<const IntSet*>& sets)
+//     Pre:  Each element of sets references a valid IntSet.
+//     Post: The intersection of all the IntSet's in sets is returned,
+//           with its elements in their order in *sets[0] (as chained
+//           intersect calls would give); an empty IntSet is returned
+//           if sets is empty.
+//     Note: Only the values of the smallest IntSet are candidates;
+//           they are probed in the other IntSet's (smallest first, in
+//           their hash indexes) and dropped as soon as one lacks them,
+//           so the time is O(k * smallest size) and stops early once
+//           no candidate is left.
+//
+// PARALLEL SET OPERATIONS
+//   IntSet unionWith(const IntSet& otherIntSet,
+//                    IntSetThreadPool& pool) const
+//   IntSet intersect(const IntSet& otherIntSet,
+//                    IntSetThreadPool& pool) const
+//   IntSet subtract(const IntSet& otherIntSet,
+//                   IntSetThreadPool& pool) const
+//     Pre:  No job is running on pool (see IntSetParallel.h), and
+//           neither IntSet is changed while the call runs.
+//     Post: As for the versions without pool: the same elements are
+//           returned, in the same order.
+//     Note: The work is spread over the threads of pool: each operand
+//           is range-partitioned by position, each partition is
+//           probed against the other operand's hash index on its own,
+//           and the partitions' results are then copied into place
+//           (also in parallel) one after the other, in partition
+//           order, which is why the order is exactly that of the
+//           serial versions whatever the # of threads. The result's
+//           hash index is built in parallel too (partitioned by slot).
+//           IntSet's with fewer than PARALLEL_MIN values between them
+//           are simply handled by the serial versions.
+//     Note: Programs using these must link IntSetParallel.o (and be
+//           built with -pthread).
 //
 // NON-MEMBER FUNCTIONS
 //   bool equal(const IntSet& is1, const IntSet& is2)
@@ -95,43 +376,251 @@
 //           otherwise false is returned; for e.g.: {1,2,3}, {1,3,2},
 //           {2,1,3}, {2,3,1}, {3,1,2}, and {3,2,1} are all equal.
 //     Note: By definition, two empty IntSet's are equal.
+//     Note: Each IntSet keeps a fingerprint of its elements (updated
+//           in O(1) per change, independent of membership order), so
+//           most unequal IntSet's of the same size are told apart in
+//           O(1); otherwise the check takes expected O(n) time.
 //
 // VALUE SEMANTICS
 //   Assignment and the copy constructor may be used with IntSet
 //   objects.
+//   An IntSet may also be move-constructed or move-assigned from an
+//   IntSet that is about to go away (such as one returned by
+//   unionWith, intersect or subtract), which takes over its memory
+//   instead of copying it; the IntSet moved from is left empty (and
+//   may still be used).
 
 #ifndef INT_SET_H
 #define INT_SET_H
 
 #include <iostream>
+#include <vector>
+#include <iterator>
+#include <cstddef>
+#include "IntSetStats.h"
+
+class IntBloomFilter;                 // see IntSetBloom.h
+class IntSetSketch;                   // see IntSetSketch.h
+class IntSetThreadPool;               // see IntSetParallel.h
 
 class IntSet
 {
 public:
+   enum RemoveMode { SHIFT, TOMBSTONE };
+   struct GrowthPolicy
+   {
+      double factor;
+      int minStep;
+      int pageBytes;
+      GrowthPolicy(double factor = 1.5, int minStep = 8, int pageBytes = 0)
+      : factor(factor), minStep(minStep), pageBytes(pageBytes) { }
+   };
+   struct AllocStats
+   {
+      long allocations;
+      long intsCopied;
+      long indexBuilds;
+      int  peakCapacity;
+      AllocStats()
+      : allocations(0), intsCopied(0), indexBuilds(0), peakCapacity(0) { }
+   };
+   struct OpStats
+   {
+      unsigned long long comparisons;
+      unsigned long long moves;
+      unsigned long long reallocations;
+      unsigned long long bytesCopied;
+      OpStats()
+      : comparisons(0), moves(0), reallocations(0), bytesCopied(0) { }
+   };
+   class const_iterator
+   {
+   public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef int value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef const int* pointer;
+      typedef const int& reference;
+      const_iterator() : cur(0), last(0), deadAt(0) { }
+      reference operator*() const { return *cur; }
+      pointer operator->() const { return cur; }
+      const_iterator& operator++();
+      const_iterator operator++(int)
+         { const_iterator old(*this); ++ *this; return old; }
+      bool operator==(const const_iterator& rhs) const
+         { return cur == rhs.cur; }
+      bool operator!=(const const_iterator& rhs) const
+         { return cur != rhs.cur; }
+   private:
+      friend class IntSet;
+      const_iterator(const int* cur, const int* last, const char* deadAt)
+      : cur(cur), last(last), deadAt(deadAt) { skipDead(); }
+      void skipDead();
+      const int*  cur;
+      const int*  last;
+      const char* deadAt;       // dead flag of *cur (0 if no dead places)
+   };
+   struct View
+   {
+      const int* first;
+      int count;
+      const int* data() const { return first; }
+      int size() const { return count; }
+      const int& operator[](int i) const { return first[i]; }
+      const int* begin() const { return first; }
+      const int* end() const { return first + count; }
+   };
    static const int DEFAULT_CAPACITY = 1;
    IntSet(int initial_capacity = DEFAULT_CAPACITY);
    IntSet(const IntSet& src);
+   IntSet(IntSet&& src) noexcept;
    ~IntSet();
    IntSet& operator=(const IntSet& rhs);
+   IntSet& operator=(IntSet&& rhs) noexcept;
    int size() const;
    bool isEmpty() const;
    bool contains(int anInt) const;
    bool isSubsetOf(const IntSet& otherIntSet) const;
    void DumpData(std::ostream& out) const;
+   std::size_t DumpData(char* buf, std::size_t bufSize) const;
+   void DumpBinary(std::ostream& out) const;
    IntSet unionWith(const IntSet& otherIntSet) const;
    IntSet intersect(const IntSet& otherIntSet) const;
    IntSet subtract(const IntSet& otherIntSet) const;
+   IntSet unionWith(const IntSet& otherIntSet, IntSetThreadPool& pool) const;
+   IntSet intersect(const IntSet& otherIntSet, IntSetThreadPool& pool) const;
+   IntSet subtract(const IntSet& otherIntSet, IntSetThreadPool& pool) const;
    void reset();
    bool add(int anInt);
    bool remove(int anInt);
+   void setRemoveMode(RemoveMode mode, double maxDeadRatio = 0.25);
+   void compact();
+   void setGrowthPolicy(const GrowthPolicy& policy);
+   void reserve(int n);
+   void shrink_to_fit();
+   int currentCapacity() const;
+   const AllocStats& allocStats() const;
+   void resetAllocStats();
+   OpStats opStats() const;
+   void resetOpStats();
+   static OpStats globalOpStats();
+   static void resetGlobalOpStats();
+   static bool opStatsEnabled();
+   void setBloomFilter(double falsePositiveRate = 0.01, int maxBytes = 0);
+   void dropBloomFilter();
+   int bloomFilterBytes() const;
+   double bloomFilterRate() const;
+   void setSketch(int precision = 12, int minHashes = 256);
+   void dropSketch();
+   const IntSetSketch* getSketch() const;
+   double estimateUnionSize(const IntSet& otherIntSet) const;
+   double estimateJaccard(const IntSet& otherIntSet) const;
+   int addAll(const int* first, const int* last);
+   template <class InputIterator>
+   int addAll(InputIterator first, InputIterator last);
+   IntSet& operator|=(const IntSet& otherIntSet);
+   IntSet& operator&=(const IntSet& otherIntSet);
+   IntSet& operator-=(const IntSet& otherIntSet);
+   const_iterator begin() const;
+   const_iterator end() const;
+   View view();
+   static IntSet unionAll(const std::vector<const IntSet*>& sets);
+   static IntSet intersectAll(const std::vector<const IntSet*>& sets);
 
 private:
+   static const int INDEX_THRESHOLD = 16;
+   static const int GALLOP_RATIO = 32;
+   static const int SCAN_LIMIT = 4096;
+   static const int MAX_CAPACITY = 0x3FFFFFFF;
+   static const int PARALLEL_MIN = 1 << 15;
+   struct Entry
+   {
+      int value;
+      int pos;
+      bool operator<(const Entry& rhs) const { return value < rhs.value; }
+   };
    int* data;
    int  capacity;
    int  used;
+   int* index;
+   int  indexSize;
+   char* dead;
+   int   holes;
+   double deadRatio;
+   mutable Entry* sorted;
+   mutable bool   sortedValid;
+   unsigned int fpSum;
+   unsigned int fpXor;
+   IntBloomFilter* bloom;
+   IntSetSketch* sketch;
+   GrowthPolicy growth;
+   AllocStats   stats;
+#ifdef INTSET_STATS
+   mutable IntSetCounters opCounters;
+   static IntSetCounters globalCounters;
+#endif
    void resize(int new_capacity);
+   int  grownCapacity(int needed) const;
+   void steal(IntSet& src);
+   bool isLive(int pos) const;
+   void keepFlagged(const char* hit, char keep);
+   void memberIn(int anInt);
+   void memberOut(int anInt);
+   void summaryUpkeep();
+   void rebuildBloom();
+   void rebuildSketch();
+   int countCommon(const IntSet& otherIntSet) const;
+   const Entry* sortedView() const;
+   void invalidateSorted();
+   int  matchSorted(const IntSet& otherIntSet,
+                    char* thisHit, char* otherHit) const;
+   int  gallop(const Entry* view, int lo, int hi, int target) const;
+   static int homeSlot(int anInt, int mask);
+   static unsigned int fingerprintOf(int anInt);
+   static int indexSizeFor(int numVals);
+   int  findSlot(int anInt) const;
+   void buildIndex(int new_size);
+   void syncIndex();
+   void indexInsert(int pos);
+   void indexErase(int slot);
+   int  markParallel(const IntSet* probe, bool keepFound, char* keep,
+                     std::vector<int>& chunkKept,
+                     IntSetThreadPool& pool) const;
+   void appendMarked(const char* keep, const std::vector<int>& chunkKept,
+                     IntSet& result, IntSetThreadPool& pool) const;
+   void buildIndexParallel(IntSetThreadPool& pool);
+   friend bool operator==(const IntSet& is1, const IntSet& is2);
 };
 
 bool operator==(const IntSet& is1, const IntSet& is2);
 
+inline IntSet::const_iterator& IntSet::const_iterator::operator++()
+{
+   ++ cur;
+   if( deadAt )
+      ++ deadAt;
+   skipDead();
+   return *this;
+}
+
+inline void IntSet::const_iterator::skipDead()
+{
+   if( deadAt )
+      while( cur != last && *deadAt )
+      {
+         ++ cur;
+         ++ deadAt;
+      }
+}
+
+template <class InputIterator>
+int IntSet::addAll(InputIterator first, InputIterator last)
+{
+   // gather the values so the pointer version can size things up front
+   std::vector<int> values(first, last);
+   const int* begin = values.empty() ? 0 : &values[0];
+
+   return addAll(begin, begin + values.size());
+}
+
 #endif
@@ -0,0 +1,296 @@
+// FILE: IntSetBench.cpp
+//       A benchmark of the basic operations of every set class of asg02
+//       with the IntSet interface, at sizes from 10 up to 10^7, with
+//       machine-readable (CSV or JSON) output for tracking performance
+//       from one version to the next.
+//
+// DESCRIPTION:
+// For each set class and each size n (10, 100, ..., up to max_size, or
+// the class's own LIMIT if that is lower; see the table in main), the
+// workload is built from a random permutation of 2n distinct values
+// (-n .. n - 1): set A holds the first n of them, set B the middle n
+// (so half of B is in A), and the last n are the "misses". Then:
+//   add            builds A from empty, by n calls of add
+//   contains_hit   looks up each value of A in A
+//   contains_miss  looks up each miss in A
+//   remove         removes the first REMOVE_SAMPLE (or n) values of A
+//                  from a copy of A (made outside the timing)
+//   union, intersect, subtract
+//                  A.unionWith(B), A.intersect(B), A.subtract(B) (the
+//                  same A and B each time, so caches kept by the sets,
+//                  such as IntSet's sorted views, are warm)
+//   equal          A == a copy of A built in the reverse order
+// Each is repeated until it has run for MIN_NS nanoseconds (at least
+// once). One record is written per (impl, op, size):
+//   impl, op, size, calls, elements_per_call, ns_per_call,
+//   ns_per_element
+// where an "element" is a value added / looked up / removed, or a value
+// of A for the set operations and equal. The records are written to
+// cout as CSV (with a header line) or as a JSON object:
+//   { "format": 1, "benchmark": "IntSetBench", "results": [ {...}, ... ] }
+// with one object per record, named as in the CSV header. asg01 has its
+// own IntSetBench.cpp (its IntSet can't share a program with this one)
+// writing records in the same format.
+// Usage: ibench [csv|json] [max_size]
+
+#include "IntSet.h"
+#include "BitmapIntSet.h"
+#include "SmallIntSet.h"
+#include "BasicIntSet.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+const int DEFAULT_MAX_SIZE = 10000000;
+const double MIN_NS = 2e7;             // 20 ms per measurement
+const int REMOVE_SAMPLE = 100;
+
+struct Record
+{
+   string impl;
+   const char* op;
+   int size;
+   long calls;
+   int elements;                       // per call
+   double nsPerCall;
+};
+
+struct Workload
+{
+   vector<int> values;                 // A = [0, n), B = [n/2, 3n/2),
+   int n;                              // misses = [n, 2n)
+   const int* inA() const { return &values[0]; }
+   const int* inB() const { return &values[n / 2]; }
+   const int* misses() const { return &values[n]; }
+};
+
+void makeWorkload(int n, Workload& work);
+// Pre:  n >= 1
+// Post: work holds a random permutation of -n .. n - 1, and work.n == n.
+
+template <class Set>
+void benchSet(const string& impl, int maxSize, vector<Record>& records);
+// Pre:  maxSize >= 10
+// Post: A Record for each op and each size 10, 100, ... <= maxSize has
+//       been appended to records for the set class Set.
+
+template <class Body>
+void measure(const string& impl, const char* op, int size, int elements,
+             Body body, vector<Record>& records);
+// Pre:  body() returns the # of nanoseconds it spent on the operation
+//       being measured (so it may leave its own setup out).
+// Post: body has been called until the times add up to MIN_NS (at least
+//       once), and a Record of the average has been appended to records.
+
+void writeCsv(const vector<Record>& records, ostream& out);
+void writeJson(const vector<Record>& records, ostream& out);
+// Post: records have been written to out in the format described above.
+
+static volatile long sink = 0;         // (keeps the results "used")
+
+int main(int argc, char* argv[])
+{
+   bool json = ( argc > 1 && strcmp(argv[1], "json") == 0 );
+   int maxSize = ( argc > 2 ) ? atoi(argv[2]) : DEFAULT_MAX_SIZE;
+   if( argc > 1 && !json && strcmp(argv[1], "csv") != 0 )
+   {
+      cerr << "usage: ibench [csv|json] [max_size]" << endl;
+      return EXIT_FAILURE;
+   }
+   if( maxSize < 10 )
+      maxSize = 10;
+
+   // the classes whose add is O(n) (a scan or a shift per value) would
+   // take hours at the top sizes, so they stop at their LIMIT
+   const int UNLIMITED = DEFAULT_MAX_SIZE;
+   const int QUADRATIC_LIMIT = 100000;
+   vector<Record> records;
+
+   benchSet<IntSet>("asg02/IntSet", min(maxSize, UNLIMITED), records);
+   benchSet<BitmapIntSet>("BitmapIntSet", min(maxSize, UNLIMITED), records);
+   benchSet< SmallIntSet<16> >("SmallIntSet<16>",
+                               min(maxSize, QUADRATIC_LIMIT), records);
+   benchSet< BasicIntSet<int, HashRep<int> > >("BasicIntSet<int,HashRep>",
+                               min(maxSize, UNLIMITED), records);
+   benchSet< BasicIntSet<int, SortedRep<int> > >("BasicIntSet<int,SortedRep>",
+                               min(maxSize, QUADRATIC_LIMIT), records);
+   benchSet< BasicIntSet<int, UnsortedRep<int> > >("BasicIntSet<int,UnsortedRep>",
+                               min(maxSize, QUADRATIC_LIMIT), records);
+   benchSet< BasicIntSet<int, RunRep<int> > >("BasicIntSet<int,RunRep>",
+                               min(maxSize, QUADRATIC_LIMIT), records);
+
+   if( json )
+      writeJson(records, cout);
+   else
+      writeCsv(records, cout);
+
+   return EXIT_SUCCESS;
+}
+
+void makeWorkload(int n, Workload& work)
+{
+   work.n = n;
+   work.values.resize(2 * n);
+   for( int i = 0; i < 2 * n; i ++ )
+      work.values[i] = i - n;
+
+   unsigned int x = 2463534242U + n;               // xorshift shuffle
+   for( int i = 2 * n - 1; i > 0; i -- )
+   {
+      x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+      swap(work.values[i], work.values[x % ( i + 1 )]);
+   }
+}
+
+template <class Set>
+void benchSet(const string& impl, int maxSize, vector<Record>& records)
+{
+   typedef chrono::steady_clock Clock;
+
+   for( int n = 10; n <= maxSize; n *= 10 )
+   {
+      Workload work;
+      makeWorkload(n, work);
+      const int* inA = work.inA();
+      const int* inB = work.inB();
+      const int* misses = work.misses();
+
+      Set a;
+      Set b;
+      Set reversed;
+      for( int i = 0; i < n; i ++ )
+      {
+         a.add(inA[i]);
+         b.add(inB[i]);
+         reversed.add(inA[n - 1 - i]);
+      }
+
+      measure(impl, "add", n, n, [&]() -> double
+      {
+         Clock::time_point start = Clock::now();
+         Set s;
+         for( int i = 0; i < n; i ++ )
+            s.add(inA[i]);
+         sink += s.size();
+         return chrono::duration<double, nano>(Clock::now() - start).count();
+      }, records);
+
+      measure(impl, "contains_hit", n, n, [&]() -> double
+      {
+         Clock::time_point start = Clock::now();
+         int hits = 0;
+         for( int i = 0; i < n; i ++ )
+            hits += a.contains(inA[i]);
+         sink += hits;
+         return chrono::duration<double, nano>(Clock::now() - start).count();
+      }, records);
+
+      measure(impl, "contains_miss", n, n, [&]() -> double
+      {
+         Clock::time_point start = Clock::now();
+         int hits = 0;
+         for( int i = 0; i < n; i ++ )
+            hits += a.contains(misses[i]);
+         sink += hits;
+         return chrono::duration<double, nano>(Clock::now() - start).count();
+      }, records);
+
+      int sample = min(n, REMOVE_SAMPLE);
+      measure(impl, "remove", n, sample, [&]() -> double
+      {
+         Set s(a);
+         Clock::time_point start = Clock::now();
+         for( int i = 0; i < sample; i ++ )   // (A's values are already
+            s.remove(inA[i]);                 //  in random order)
+         double ns = chrono::duration<double, nano>(Clock::now() - start).count();
+         sink += s.size();
+         return ns;
+      }, records);
+
+      measure(impl, "union", n, n, [&]() -> double
+      {
+         Clock::time_point start = Clock::now();
+         Set r = a.unionWith(b);
+         sink += r.size();
+         return chrono::duration<double, nano>(Clock::now() - start).count();
+      }, records);
+
+      measure(impl, "intersect", n, n, [&]() -> double
+      {
+         Clock::time_point start = Clock::now();
+         Set r = a.intersect(b);
+         sink += r.size();
+         return chrono::duration<double, nano>(Clock::now() - start).count();
+      }, records);
+
+      measure(impl, "subtract", n, n, [&]() -> double
+      {
+         Clock::time_point start = Clock::now();
+         Set r = a.subtract(b);
+         sink += r.size();
+         return chrono::duration<double, nano>(Clock::now() - start).count();
+      }, records);
+
+      measure(impl, "equal", n, n, [&]() -> double
+      {
+         Clock::time_point start = Clock::now();
+         sink += ( a == reversed );
+         return chrono::duration<double, nano>(Clock::now() - start).count();
+      }, records);
+   }
+}
+
+template <class Body>
+void measure(const string& impl, const char* op, int size, int elements,
+             Body body, vector<Record>& records)
+{
+   double total = 0;
+   long calls = 0;
+   while( calls == 0 || total < MIN_NS )
+   {
+      total += body();
+      calls ++;
+   }
+
+   Record r;
+   r.impl = impl;
+   r.op = op;
+   r.size = size;
+   r.calls = calls;
+   r.elements = elements;
+   r.nsPerCall = total / calls;
+   records.push_back(r);
+}
+
+void writeCsv(const vector<Record>& records, ostream& out)
+{
+   out << "impl,op,size,calls,elements_per_call,ns_per_call,ns_per_element\n";
+   for( size_t i = 0; i < records.size(); i ++ )
+   {
+      const Record& r = records[i];
+      out << '"' << r.impl << "\"," << r.op << ',' << r.size << ','
+          << r.calls << ',' << r.elements << ',' << r.nsPerCall << ','
+          << r.nsPerCall / r.elements << '\n';
+   }
+}
+
+void writeJson(const vector<Record>& records, ostream& out)
+{
+   out << "{ \"format\": 1, \"benchmark\": \"IntSetBench\", \"results\": [";
+   for( size_t i = 0; i < records.size(); i ++ )
+   {
+      const Record& r = records[i];
+      out << ( i == 0 ? "\n" : ",\n" )
+          << "  { \"impl\": \"" << r.impl << "\", \"op\": \"" << r.op
+          << "\", \"size\": " << r.size << ", \"calls\": " << r.calls
+          << ", \"elements_per_call\": " << r.elements
+          << ", \"ns_per_call\": " << r.nsPerCall
+          << ", \"ns_per_element\": " << r.nsPerCall / r.elements << " }";
+   }
+   out << "\n] }\n";
+}
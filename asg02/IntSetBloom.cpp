@@ -0,0 +1,156 @@
+// FILE: IntSetBloom.cpp
+//       Implementation file for the IntBloomFilter class
+//       (See IntSetBloom.h for documentation.)
+// INVARIANT for the IntBloomFilter class:
+// (1) The bits are held in words (64 per element); the # of bits is a
+//     power of 2, mask + 1, so a bit # is picked with "& mask". Before
+//     the first build, words is empty and mask is 0.
+// (2) Each value sets (and is checked against) hashes bits, bit #'s
+//     h1, h1 + h2, h1 + 2 * h2, ... (mod # of bits), where h1 and h2
+//     are the two halves of a 64-bit mix of the value ("double
+//     hashing", as good as hashes independent hash functions).
+// (3) planned is the # of values the filter was last sized for,
+//     inserted is the # of insert calls since then and removed the #
+//     of noteRemoval calls; rate and limit are the configured target
+//     false-positive rate and byte limit (0: none).
+
+#include "IntSetBloom.h"
+#include <cmath>
+using namespace std;
+
+// ========================================================================
+
+static unsigned long long mix64(int anInt)
+
+// this function scrambles anInt into 64 well-mixed bits (the SplitMix64
+// finalizer)
+{
+   unsigned long long z = static_cast<unsigned int>(anInt)
+                          + 0x9e3779b97f4a7c15ULL;
+   z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+   z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+   return z ^ ( z >> 31 );
+}
+
+// ========================================================================
+
+IntBloomFilter::IntBloomFilter(double falsePositiveRate, int maxBytes)
+: mask(0), hashes(1), planned(0), inserted(0), removed(0),
+  rate(falsePositiveRate), limit(maxBytes)
+{
+}
+
+// ========================================================================
+
+void IntBloomFilter::build(int numVals)
+
+// this function picks the optimal # of bits (n ln(1/p) / ln(2)^2,
+// rounded up to a power of 2 and cut back to the byte limit) and the
+// optimal # of hashes for that many bits, (bits / n) ln 2
+{
+   if( numVals < 64 )
+      numVals = 64;
+
+   const double LN2 = 0.6931471805599453;
+   double wanted = numVals * -log(rate) / ( LN2 * LN2 );
+
+   unsigned long long bits = 64;
+   while( bits < wanted && bits < ( 1ULL << 31 ) )
+      bits *= 2;
+   while( limit > 0 && bits > 64 && bits / 8 > static_cast<unsigned long long>(limit) )
+      bits /= 2;
+
+   hashes = static_cast<int>( bits / static_cast<double>(numVals) * LN2 + 0.5 );
+   if( hashes < 1 )
+      hashes = 1;
+   if( hashes > 16 )
+      hashes = 16;
+
+   words.assign(bits / 64, 0);
+   mask = static_cast<unsigned int>( bits - 1 );
+   planned = numVals;
+   inserted = 0;
+   removed = 0;
+}
+
+// ========================================================================
+
+void IntBloomFilter::insert(int anInt)
+{
+   unsigned long long h = mix64(anInt);
+   unsigned int h1 = static_cast<unsigned int>(h);
+   unsigned int h2 = static_cast<unsigned int>( h >> 32 ) | 1;
+
+   for( int i = 0; i < hashes; i ++ )
+   {
+      unsigned int bit = ( h1 + i * h2 ) & mask;
+      words[bit >> 6] |= 1ULL << ( bit & 63 );
+   }
+   inserted ++;
+}
+
+// ========================================================================
+
+bool IntBloomFilter::mayContain(int anInt) const
+{
+   unsigned long long h = mix64(anInt);
+   unsigned int h1 = static_cast<unsigned int>(h);
+   unsigned int h2 = static_cast<unsigned int>( h >> 32 ) | 1;
+
+   for( int i = 0; i < hashes; i ++ )
+   {
+      unsigned int bit = ( h1 + i * h2 ) & mask;
+      if( ( words[bit >> 6] & ( 1ULL << ( bit & 63 ) ) ) == 0 )
+         return false;
+   }
+   return true;
+}
+
+// ========================================================================
+
+void IntBloomFilter::noteRemoval()
+{
+   removed ++;
+}
+
+// ========================================================================
+
+bool IntBloomFilter::needsRebuild(int liveValues) const
+{
+   return ( inserted > planned || 4 * removed > liveValues + 64 );
+}
+
+// ========================================================================
+
+int IntBloomFilter::bytes() const
+{
+   return static_cast<int>( words.size() * sizeof(unsigned long long) );
+}
+
+// ========================================================================
+
+double IntBloomFilter::targetRate() const
+{
+   return rate;
+}
+
+// ========================================================================
+
+double IntBloomFilter::estimatedRate() const
+
+// this function evaluates (1 - e^(-k n / m))^k for k hashes, n values
+// inserted and m bits
+{
+   if( words.empty() )
+      return 0;
+
+   double m = static_cast<double>(mask) + 1;
+   return pow(1 - exp(-hashes * static_cast<double>(inserted) / m), hashes);
+}
+
+// ========================================================================
+
+int IntBloomFilter::maxBytes() const
+{
+   return limit;
+}
@@ -0,0 +1,81 @@
+// FILE: IntSetBloom.h - header file for the IntBloomFilter class
+// CLASS PROVIDED: IntBloomFilter (a Bloom filter over int values, used
+//                 by IntSet to turn away most lookups of non-members
+//                 without touching its data)
+//
+// A Bloom filter answers "may anInt be in the set?": "no" is always
+// right, while "yes" is wrong for a small fraction of non-members (the
+// false-positive rate). The filter is sized for a planned # of values
+// and a target rate; as more values than planned are inserted, or
+// values are removed (which a Bloom filter can't forget), the real rate
+// drifts up, so its owner rebuilds it (see needsRebuild).
+//
+// CONSTRUCTOR
+//   IntBloomFilter(double falsePositiveRate, int maxBytes)
+//     Pre:  0 < falsePositiveRate < 1; maxBytes >= 0
+//     Post: The filter is configured for the given target rate, using
+//           at most maxBytes bytes of bits (no limit if maxBytes is 0);
+//           it holds no values and must be built before use.
+//
+// MEMBER FUNCTIONS
+//   void build(int numVals)
+//     Pre:  numVals >= 0
+//     Post: The filter is emptied and sized for max(numVals, 64)
+//           values at the target rate (within maxBytes).
+//   void insert(int anInt)
+//     Post: anInt has been recorded in the filter.
+//   bool mayContain(int anInt) const
+//     Post: false is returned if anInt was never inserted since the
+//           last build; true is returned otherwise (and, with
+//           about the false-positive rate, for other values too).
+//   void noteRemoval()
+//     Post: The filter has been told that one recorded value has left
+//           the set (its bits stay set).
+//   bool needsRebuild(int liveValues) const
+//     Post: True is returned if more values than planned have been
+//           inserted, or if the removed ones exceed a quarter of
+//           liveValues, i.e. if the real rate is well off the target.
+//   int bytes() const
+//     Post: The # of bytes of bits the filter uses is returned.
+//   double targetRate() const
+//   double estimatedRate() const
+//     Post: The configured rate, or the expected rate for the values
+//           inserted so far (removed ones included), is returned.
+//   int maxBytes() const
+//     Post: The configured memory limit (0 for none) is returned.
+//
+// VALUE SEMANTICS
+//   Assignment and the copy constructor may be used with
+//   IntBloomFilter objects.
+
+#ifndef INT_SET_BLOOM_H
+#define INT_SET_BLOOM_H
+
+#include <vector>
+
+class IntBloomFilter
+{
+public:
+   IntBloomFilter(double falsePositiveRate, int maxBytes);
+   void build(int numVals);
+   void insert(int anInt);
+   bool mayContain(int anInt) const;
+   void noteRemoval();
+   bool needsRebuild(int liveValues) const;
+   int bytes() const;
+   double targetRate() const;
+   double estimatedRate() const;
+   int maxBytes() const;
+
+private:
+   std::vector<unsigned long long> words;
+   unsigned int mask;          // # of bits - 1 (a power of 2 - 1)
+   int hashes;                 // # of bits set per value
+   int planned;                // # of values the filter was sized for
+   int inserted;               // # of values inserted since built
+   int removed;                // # of those since removed
+   double rate;
+   int limit;
+};
+
+#endif
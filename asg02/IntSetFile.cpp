@@ -0,0 +1,435 @@
+// FILE: IntSetFile.cpp
+//       Implementation file for the IntSet binary file format
+//       (See IntSetFile.h for documentation.)
+// INVARIANT for the MappedIntSet class:
+// (1) When a file is mapped, the member variable base references the
+//     first byte of its mapping and length is the # of bytes mapped;
+//     the header and the section sizes have been checked to agree
+//     with length (see validHeader), so every section lies inside
+//     the mapping. When no file is mapped, base is 0 and length is 0.
+// (2) The varints of a block are only trusted as far as the end of the
+//     block data section: decoding stops (as if the value wasn't found)
+//     rather than read past it, so a corrupt file can't cause a read
+//     outside the mapping.
+
+#include "IntSetFile.h"
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+
+namespace
+{
+   const unsigned int MAGIC = 0x54534E49U;     // "INST"
+   const unsigned int VERSION = 1;
+   const unsigned int FLAG_ORDER = 1;
+   const unsigned int BLOCK_SIZE = 128;
+   const int HEADER_BYTES = 32;
+   const int INDEX_ENTRY_BYTES = 8;
+
+   struct Header
+   {
+      unsigned int magic;
+      unsigned int version;
+      unsigned int flags;
+      unsigned int count;
+      unsigned int blockSize;
+      unsigned int numBlocks;
+      unsigned int dataBytes;
+      unsigned int orderBytes;
+   };
+
+   // ======================================================================
+
+   void put32(vector<unsigned char>& out, unsigned int x)
+   {
+      for( int b = 0; b < 4; b ++ )
+         out.push_back( static_cast<unsigned char>( x >> ( 8 * b ) ) );
+   }
+
+   // ======================================================================
+
+   unsigned int get32(const unsigned char* p)
+   {
+      return static_cast<unsigned int>(p[0])
+             | ( static_cast<unsigned int>(p[1]) << 8 )
+             | ( static_cast<unsigned int>(p[2]) << 16 )
+             | ( static_cast<unsigned int>(p[3]) << 24 );
+   }
+
+   // ======================================================================
+
+   void putVarint(vector<unsigned char>& out, unsigned int x)
+   {
+      while( x >= 0x80 )
+      {
+         out.push_back( static_cast<unsigned char>( x | 0x80 ) );
+         x >>= 7;
+      }
+      out.push_back( static_cast<unsigned char>(x) );
+   }
+
+   // ======================================================================
+
+   bool getVarint(const unsigned char*& p, const unsigned char* end,
+                  unsigned int& x)
+
+   // this function decodes the varint at p (advancing p past it), and
+   // returns false if it runs past end or is longer than 5 bytes
+   {
+      x = 0;
+      for( int shift = 0; shift < 35; shift += 7 )
+      {
+         if( p == end )
+            return false;
+         unsigned char byte = *p ++;
+         x |= static_cast<unsigned int>( byte & 0x7F ) << shift;
+         if( ( byte & 0x80 ) == 0 )
+            return true;
+      }
+      return false;
+   }
+
+   // ======================================================================
+
+   int addTo(int value, unsigned int delta)
+
+   // this function adds delta to value modulo 2^32 (the int wraps the
+   // way the file's unsigned differences were taken)
+   {
+      return static_cast<int>( static_cast<unsigned int>(value) + delta );
+   }
+
+   // ======================================================================
+
+   bool validHeader(const unsigned char* base, size_t length, Header& h)
+
+   // this function reads the header and checks that it describes a file
+   // of exactly length bytes that this version can read
+   {
+      if( length < static_cast<size_t>(HEADER_BYTES) )
+         return false;
+
+      h.magic = get32(base);
+      h.version = get32(base + 4);
+      h.flags = get32(base + 8);
+      h.count = get32(base + 12);
+      h.blockSize = get32(base + 16);
+      h.numBlocks = get32(base + 20);
+      h.dataBytes = get32(base + 24);
+      h.orderBytes = get32(base + 28);
+
+      if( h.magic != MAGIC || h.version != VERSION || h.blockSize == 0 ||
+          h.count > 0x7FFFFFFFU )
+         return false;
+      if( h.numBlocks != h.count / h.blockSize
+                         + ( h.count % h.blockSize != 0 ) )
+         return false;
+      if( ( h.orderBytes != 0 ) != ( ( h.flags & FLAG_ORDER ) != 0 ) )
+         return false;
+
+      unsigned long long expected = HEADER_BYTES
+         + static_cast<unsigned long long>(INDEX_ENTRY_BYTES) * h.numBlocks
+         + h.dataBytes + h.orderBytes;
+      return ( expected == length );
+   }
+
+   // ======================================================================
+
+   bool decodeAll(const unsigned char* base, const Header& h, IntSet& set)
+
+   // this function decodes the insertion-order section if there is one
+   // (the sorted blocks otherwise) and adds the values in bulk
+   {
+      const unsigned char* index = base + HEADER_BYTES;
+      const unsigned char* data = index + INDEX_ENTRY_BYTES * h.numBlocks;
+      const unsigned char* dataEnd = data + h.dataBytes;
+      vector<int> values;
+      values.reserve(h.count);
+
+      if( h.flags & FLAG_ORDER )
+      {
+         const unsigned char* p = dataEnd;
+         const unsigned char* end = p + h.orderBytes;
+         int prev = 0;
+         for( unsigned int i = 0; i < h.count; i ++ )
+         {
+            unsigned int z;
+            if( !getVarint(p, end, z) )
+               return false;
+            prev = addTo(prev, ( z >> 1 ) ^ ( 0U - ( z & 1 ) ));
+            values.push_back(prev);
+         }
+      }
+      else
+      {
+         for( unsigned int b = 0; b < h.numBlocks; b ++ )
+         {
+            const unsigned char* entry = index + INDEX_ENTRY_BYTES * b;
+            unsigned int offset = get32(entry + 4);
+            if( offset > h.dataBytes )
+               return false;
+
+            const unsigned char* p = data + offset;
+            int value = static_cast<int>( get32(entry) );
+            unsigned int n = min(h.blockSize, h.count - b * h.blockSize);
+            values.push_back(value);
+            for( unsigned int i = 1; i < n; i ++ )
+            {
+               unsigned int delta;
+               if( !getVarint(p, dataEnd, delta) )
+                  return false;
+               value = addTo(value, delta);
+               values.push_back(value);
+            }
+         }
+      }
+
+      IntSet result;
+      result.addAll(values.begin(), values.end());
+      if( result.size() != static_cast<int>(h.count) )
+         return false;                         // repeated values: corrupt
+      set = std::move(result);
+      return true;
+   }
+}
+
+// ========================================================================
+
+bool saveIntSet(const IntSet& set, const char* path, bool keepOrder)
+
+// this function collects the live values (in membership order), sorts a
+// copy, and lays out the header, block index, deltas and (if wanted)
+// the zigzag-encoded insertion order in one buffer before writing it
+{
+   vector<int> inOrder(set.begin(), set.end());
+
+   vector<int> ascending(inOrder);
+   sort(ascending.begin(), ascending.end());
+
+   unsigned int count = static_cast<unsigned int>( ascending.size() );
+   unsigned int numBlocks = ( count + BLOCK_SIZE - 1 ) / BLOCK_SIZE;
+
+   vector<unsigned char> index;
+   vector<unsigned char> data;
+   for( unsigned int b = 0; b < numBlocks; b ++ )
+   {
+      unsigned int first = b * BLOCK_SIZE;
+      unsigned int last = min(first + BLOCK_SIZE, count);
+
+      put32(index, static_cast<unsigned int>( ascending[first] ));
+      put32(index, static_cast<unsigned int>( data.size() ));
+      for( unsigned int i = first + 1; i < last; i ++ )
+         putVarint(data, static_cast<unsigned int>(ascending[i])
+                         - static_cast<unsigned int>(ascending[i - 1]));
+   }
+
+   vector<unsigned char> order;
+   if( keepOrder )
+   {
+      int prev = 0;
+      for( unsigned int i = 0; i < count; i ++ )
+      {
+         unsigned int d = static_cast<unsigned int>(inOrder[i])
+                          - static_cast<unsigned int>(prev);
+         putVarint(order, ( d << 1 ) ^ ( 0U - ( d >> 31 ) ));
+         prev = inOrder[i];
+      }
+   }
+
+   vector<unsigned char> header;
+   put32(header, MAGIC);
+   put32(header, VERSION);
+   put32(header, ( keepOrder && count > 0 ) ? FLAG_ORDER : 0);
+   put32(header, count);
+   put32(header, BLOCK_SIZE);
+   put32(header, numBlocks);
+   put32(header, static_cast<unsigned int>( data.size() ));
+   put32(header, static_cast<unsigned int>( order.size() ));
+
+   ofstream out(path, ios::binary | ios::trunc);
+   if( !out )
+      return false;
+
+   const vector<unsigned char>* parts[4] = { &header, &index, &data, &order };
+   for( int k = 0; k < 4; k ++ )
+   {
+      if( !parts[k]->empty() )
+         out.write(reinterpret_cast<const char*>( &(*parts[k])[0] ),
+                   static_cast<streamsize>( parts[k]->size() ));
+   }
+   out.close();
+   return !out.fail();
+}
+
+// ========================================================================
+
+bool loadIntSet(const char* path, IntSet& set)
+
+// this function reads the whole file into memory and decodes it
+{
+   ifstream in(path, ios::binary);
+   if( !in )
+      return false;
+
+   vector<unsigned char> bytes( (istreambuf_iterator<char>(in)),
+                                istreambuf_iterator<char>() );
+   Header h;
+   if( !validHeader(bytes.empty() ? 0 : &bytes[0], bytes.size(), h) )
+      return false;
+
+   return decodeAll(&bytes[0], h, set);
+}
+
+// ========================================================================
+
+MappedIntSet::MappedIntSet()
+: base(0), length(0)
+{
+}
+
+// ========================================================================
+
+MappedIntSet::~MappedIntSet()
+{
+   close();
+}
+
+// ========================================================================
+
+bool MappedIntSet::open(const char* path)
+
+// this function maps the whole file read-only and checks its header
+// (the mapping stays valid after the file descriptor is closed)
+{
+   close();
+
+   int fd = ::open(path, O_RDONLY);
+   if( fd < 0 )
+      return false;
+
+   struct stat info;
+   if( fstat(fd, &info) != 0 || info.st_size < HEADER_BYTES )
+   {
+      ::close(fd);
+      return false;
+   }
+
+   size_t size = static_cast<size_t>( info.st_size );
+   void* mapped = mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+   ::close(fd);
+   if( mapped == MAP_FAILED )
+      return false;
+
+   Header h;
+   if( !validHeader(static_cast<const unsigned char*>(mapped), size, h) )
+   {
+      munmap(mapped, size);
+      return false;
+   }
+
+   base = static_cast<const unsigned char*>(mapped);
+   length = size;
+   return true;
+}
+
+// ========================================================================
+
+void MappedIntSet::close()
+{
+   if( base )
+      munmap(const_cast<unsigned char*>(base), length);
+   base = 0;
+   length = 0;
+}
+
+// ========================================================================
+
+bool MappedIntSet::isOpen() const
+{
+   return ( base != 0 );
+}
+
+// ========================================================================
+
+int MappedIntSet::size() const
+{
+   return base ? static_cast<int>( get32(base + 12) ) : 0;
+}
+
+// ========================================================================
+
+bool MappedIntSet::hasOrder() const
+{
+   return base && ( get32(base + 8) & FLAG_ORDER );
+}
+
+// ========================================================================
+
+bool MappedIntSet::contains(int anInt) const
+
+// this function binary searches the block index for the last block
+// whose first value is <= anInt, then decodes that block's deltas only
+// until it reaches or passes anInt
+{
+   if( !base )
+      return false;
+
+   unsigned int count = get32(base + 12);
+   unsigned int blockSize = get32(base + 16);
+   unsigned int numBlocks = get32(base + 20);
+   unsigned int dataBytes = get32(base + 24);
+   const unsigned char* index = base + HEADER_BYTES;
+   const unsigned char* data = index + INDEX_ENTRY_BYTES * numBlocks;
+
+   unsigned int lo = 0;                   // first block with first value
+   unsigned int hi = numBlocks;           // > anInt is found in [lo, hi]
+   while( lo < hi )
+   {
+      unsigned int mid = lo + ( hi - lo ) / 2;
+      if( static_cast<int>( get32(index + INDEX_ENTRY_BYTES * mid) ) <= anInt )
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   if( lo == 0 )
+      return false;                       // anInt is below every value
+
+   unsigned int b = lo - 1;
+   const unsigned char* entry = index + INDEX_ENTRY_BYTES * b;
+   int value = static_cast<int>( get32(entry) );
+   unsigned int offset = get32(entry + 4);
+   if( value == anInt )
+      return true;
+   if( offset > dataBytes )
+      return false;
+
+   const unsigned char* p = data + offset;
+   const unsigned char* end = data + dataBytes;
+   unsigned int n = min(blockSize, count - b * blockSize);
+   for( unsigned int i = 1; i < n; i ++ )
+   {
+      unsigned int delta;
+      if( !getVarint(p, end, delta) )
+         return false;
+      value = addTo(value, delta);
+      if( value >= anInt )
+         return ( value == anInt );
+   }
+   return false;
+}
+
+// ========================================================================
+
+bool MappedIntSet::toIntSet(IntSet& set) const
+{
+   Header h;
+   if( !base || !validHeader(base, length, h) )
+      return false;
+
+   return decodeAll(base, h, set);
+}
@@ -0,0 +1,106 @@
+// FILE: IntSetFile.h - header file for the IntSet binary file format
+// FUNCTIONS and CLASS PROVIDED: saving an IntSet to a binary file,
+//                 loading it back, and MappedIntSet (read-only access
+//                 to a saved IntSet through a memory mapping)
+//
+// FILE FORMAT (version 1; all integers little-endian)
+//   header (32 bytes): 8 unsigned 32-bit fields
+//     magic       - 0x54534E49 (the bytes "INST")
+//     version     - 1
+//     flags       - bit 0 set if there is an insertion-order section
+//     count       - # of values
+//     blockSize   - # of values per block (the last block may be short)
+//     numBlocks   - # of blocks, (count + blockSize - 1) / blockSize
+//     dataBytes   - # of bytes in the block data section
+//     orderBytes  - # of bytes in the insertion-order section (or 0)
+//   block index (8 bytes per block): for each block, its first value
+//     (a signed 32-bit int) and the offset of its deltas from the start
+//     of the block data section (unsigned 32-bit)
+//   block data: the values in ascending order, blockSize per block;
+//     after the first value of a block (which is in the block index),
+//     each value is stored as its difference from the value before
+//     it, as a varint (7 bits per byte, low bits first, high bit set
+//     on every byte but the last)
+//   insertion order (optional): the values in membership order, each
+//     stored as the zigzag-encoded difference from the previous one
+//     (from 0 for the first) as a varint
+//
+// FUNCTIONS
+//   bool saveIntSet(const IntSet& set, const char* path,
+//                   bool keepOrder = true)
+//     Pre:  (none)
+//     Post: set has been written to the file path (replacing it), with
+//           an insertion-order section if keepOrder is true, and true
+//           is returned; false is returned if the file couldn't be
+//           written.
+//   bool loadIntSet(const char* path, IntSet& set)
+//     Pre:  (none)
+//     Post: If path is a valid IntSet file, set holds its values (in
+//           membership order if the file has an insertion-order
+//           section, otherwise in ascending order) and true is
+//           returned; otherwise set is unchanged and false is returned.
+//     Note: The values are added in bulk (see IntSet::addAll), which is
+//           much faster than add()'ing them one at a time.
+//
+// CLASS MappedIntSet
+//   Answers contains() straight from the mapped pages of a saved
+//   IntSet (without decoding the file into memory): a binary search of
+//   the block index picks the one block that may hold the value, and
+//   only that block is decoded, so a lookup touches O(log # of blocks)
+//   index entries and at most blockSize varints.
+//
+//   MappedIntSet()
+//     Post: The MappedIntSet is closed (and empty).
+//   ~MappedIntSet()
+//     Post: The mapping (if any) has been released.
+//   bool open(const char* path)
+//     Pre:  (none)
+//     Post: Any mapping the MappedIntSet had is released; if path is a
+//           valid IntSet file it is mapped and true is returned,
+//           otherwise the MappedIntSet is closed and false is returned.
+//   void close()
+//     Post: The mapping (if any) has been released.
+//   bool isOpen() const
+//   int size() const
+//   bool hasOrder() const
+//     Post: Whether a file is mapped, the # of values in it (0 if
+//           closed), and whether it has an insertion-order section.
+//   bool contains(int anInt) const
+//     Post: True is returned if the mapped file has anInt as a value,
+//           otherwise (or if closed) false is returned.
+//   bool toIntSet(IntSet& set) const
+//     Post: As for loadIntSet, from the mapped file.
+//
+// VALUE SEMANTICS
+//   MappedIntSet objects may not be copied or assigned.
+
+#ifndef INT_SET_FILE_H
+#define INT_SET_FILE_H
+
+#include "IntSet.h"
+#include <cstddef>
+
+bool saveIntSet(const IntSet& set, const char* path, bool keepOrder = true);
+bool loadIntSet(const char* path, IntSet& set);
+
+class MappedIntSet
+{
+public:
+   MappedIntSet();
+   ~MappedIntSet();
+   bool open(const char* path);
+   void close();
+   bool isOpen() const;
+   int size() const;
+   bool hasOrder() const;
+   bool contains(int anInt) const;
+   bool toIntSet(IntSet& set) const;
+
+private:
+   const unsigned char* base;
+   size_t length;
+   MappedIntSet(const MappedIntSet&);           // not copyable
+   MappedIntSet& operator=(const MappedIntSet&);
+};
+
+#endif
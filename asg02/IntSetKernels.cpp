@@ -0,0 +1,214 @@
+// FILE: IntSetKernels.cpp
+//       Implementation file for the IntSet search kernels
+//       (See IntSetKernels.h for documentation.)
+// NOTE: The SSE4.2 and AVX2 versions are compiled with per-function
+//       target attributes, so the rest of the program needs no special
+//       compiler flags and still runs on CPUs without those extensions;
+//       they are only ever called after the CPU has been checked.
+
+#include "IntSetKernels.h"
+#include <atomic>
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#define INT_SET_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace
+{
+   typedef int (*FindFn)(const int*, int, int);
+
+   int resolveFindInt(const int* data, int n, int key);
+
+   std::atomic<FindFn> findIntImpl(resolveFindInt); // bound on 1st call
+
+   // ======================================================================
+
+   FindFn pickFindInt()
+
+   // this function picks the widest findInt version the CPU supports
+   {
+      if( hasAvx2() )
+         return findIntAvx2;
+      if( hasSse42() )
+         return findIntSse42;
+      return findIntScalar;
+   }
+
+   // ======================================================================
+
+   int resolveFindInt(const int* data, int n, int key)
+
+   // this function stands in for findIntImpl until the first call, when
+   // it binds findIntImpl to the right version (two threads doing so at
+   // once both store the same value, so relaxed ordering is enough)
+   {
+      FindFn chosen = pickFindInt();
+      findIntImpl.store(chosen, std::memory_order_relaxed);
+      return chosen(data, n, key);
+   }
+}
+
+// ==========================================================================
+
+bool hasSse42()
+{
+#ifdef INT_SET_KERNELS_X86
+   __builtin_cpu_init();
+   return __builtin_cpu_supports("sse4.2");
+#else
+   return false;
+#endif
+}
+
+// ==========================================================================
+
+bool hasAvx2()
+{
+#ifdef INT_SET_KERNELS_X86
+   __builtin_cpu_init();
+   return __builtin_cpu_supports("avx2");
+#else
+   return false;
+#endif
+}
+
+// ==========================================================================
+
+int findIntScalar(const int* data, int n, int key)
+{
+   for( int i = 0; i < n; i ++ )
+   {
+      if( data[i] == key )
+         return i;
+   }
+   return -1;
+}
+
+// ==========================================================================
+
+#ifdef INT_SET_KERNELS_X86
+
+__attribute__((target("sse4.2")))
+int findIntSse42(const int* data, int n, int key)
+
+// this function compares 4 ints at a time against key; the compare
+// mask is collapsed to 4 bits and the lowest set bit is the match
+{
+   __m128i k = _mm_set1_epi32(key);
+   int i = 0;
+
+   for( ; i + 4 <= n; i += 4 )
+   {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+      int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, k)));
+      if( mask != 0 )
+         return i + __builtin_ctz(mask);
+   }
+
+   for( ; i < n; i ++ )                     // leftover tail
+   {
+      if( data[i] == key )
+         return i;
+   }
+   return -1;
+}
+
+// ==========================================================================
+
+__attribute__((target("avx2")))
+int findIntAvx2(const int* data, int n, int key)
+
+// this function compares 8 ints at a time against key, two vectors per
+// pass so that the (rarely taken) branch is checked only once per 16
+{
+   __m256i k = _mm256_set1_epi32(key);
+   int i = 0;
+
+   for( ; i + 16 <= n; i += 16 )
+   {
+      __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+      __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 8));
+      __m256i e0 = _mm256_cmpeq_epi32(v0, k);
+      __m256i e1 = _mm256_cmpeq_epi32(v1, k);
+      if( !_mm256_testz_si256(_mm256_or_si256(e0, e1), _mm256_or_si256(e0, e1)) )
+      {
+         int mask = _mm256_movemask_ps(_mm256_castsi256_ps(e0))
+                    | ( _mm256_movemask_ps(_mm256_castsi256_ps(e1)) << 8 );
+         return i + __builtin_ctz(mask);
+      }
+   }
+
+   for( ; i + 8 <= n; i += 8 )
+   {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+      int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, k)));
+      if( mask != 0 )
+         return i + __builtin_ctz(mask);
+   }
+
+   for( ; i < n; i ++ )                     // leftover tail
+   {
+      if( data[i] == key )
+         return i;
+   }
+   return -1;
+}
+
+#else
+
+int findIntSse42(const int* data, int n, int key)
+{
+   return findIntScalar(data, n, key);
+}
+
+int findIntAvx2(const int* data, int n, int key)
+{
+   return findIntScalar(data, n, key);
+}
+
+#endif
+
+// ==========================================================================
+
+int findInt(const int* data, int n, int key)
+{
+   return findIntImpl.load(std::memory_order_relaxed)(data, n, key);
+}
+
+// ==========================================================================
+
+int scanMatch(const int* a, int n, const int* b, int m,
+              char* aHit, char* bHit)
+
+// this function looks every value of a up in b with the dispatched
+// findInt (so the inner loop runs 4 or 8 compares per instruction)
+{
+   FindFn find = findIntImpl.load(std::memory_order_relaxed);
+   int common = 0;
+
+   for( int i = 0; i < n; i ++ )
+   {
+      int j = find(b, m, a[i]);
+      if( j >= 0 )
+      {
+         if( aHit ) aHit[i] = 1;
+         if( bHit ) bHit[j] = 1;
+         common ++;
+      }
+   }
+   return common;
+}
+
+// ==========================================================================
+
+const char* kernelName()
+{
+   FindFn chosen = pickFindInt();
+
+   if( chosen == findIntAvx2 )
+      return "avx2";
+   if( chosen == findIntSse42 )
+      return "sse4.2";
+   return "scalar";
+}
@@ -0,0 +1,57 @@
+// FILE: IntSetKernels.h - header file for the IntSet search kernels
+// FUNCTIONS PROVIDED: linear-scan kernels used by IntSet (and its
+//                     benchmark) to search an unsorted array of ints
+//
+// Each kernel comes in a scalar version and in SSE4.2 and AVX2 versions
+// that compare 4 and 8 ints per instruction. The first call of a
+// dispatched function checks (once) what the running CPU supports and
+// binds it to the widest usable version; on CPUs (or compilers) without
+// SSE4.2/AVX2 the scalar version is used.
+//
+// DISPATCHED FUNCTIONS
+//   int findInt(const int* data, int n, int key)
+//     Pre:  data[0..n - 1] are valid (n >= 0).
+//     Post: The lowest i such that data[i] == key is returned, or -1
+//           if there is no such i.
+//   int scanMatch(const int* a, int n, const int* b, int m,
+//                 char* aHit, char* bHit)
+//     Pre:  a[0..n - 1] and b[0..m - 1] hold distinct values each;
+//           aHit (if not 0) has n zeroed elements and bHit (if not 0)
+//           has m zeroed elements.
+//     Post: The # of values common to a and b is returned; for each
+//           common value a[i] == b[j], aHit[i] and bHit[j] have been
+//           set to 1. (Takes O(n * m) time, so it is meant for small
+//           arrays, where it beats sorting them.)
+//   const char* kernelName()
+//     Pre:  (none)
+//     Post: "avx2", "sse4.2" or "scalar" is returned, telling which
+//           version the dispatched functions use.
+//
+// INDIVIDUAL VERSIONS (for benchmarking)
+//   int findIntScalar(const int* data, int n, int key)
+//   int findIntSse42(const int* data, int n, int key)
+//   int findIntAvx2(const int* data, int n, int key)
+//     Pre:  As for findInt; in addition, the SSE4.2 (AVX2) version
+//           may only be called if hasSse42() (hasAvx2()) is true.
+//     Post: As for findInt.
+//   bool hasSse42()
+//   bool hasAvx2()
+//     Pre:  (none)
+//     Post: True is returned if the running CPU (and this build)
+//           supports the corresponding version, otherwise false.
+
+#ifndef INT_SET_KERNELS_H
+#define INT_SET_KERNELS_H
+
+int findInt(const int* data, int n, int key);
+int scanMatch(const int* a, int n, const int* b, int m,
+              char* aHit, char* bHit);
+const char* kernelName();
+
+int findIntScalar(const int* data, int n, int key);
+int findIntSse42(const int* data, int n, int key);
+int findIntAvx2(const int* data, int n, int key);
+bool hasSse42();
+bool hasAvx2();
+
+#endif
@@ -0,0 +1,428 @@
+// FILE: IntSetParallel.cpp
+//       Implementation file for the IntSetThreadPool class and the
+//       parallel IntSet set operations
+//       (See IntSetParallel.h and IntSet.h for documentation.)
+// INVARIANT for the IntSetThreadPool class:
+// (1) workers holds the threads - 1 worker threads; each runs
+//     workerLoop until stopping is set (by the destructor).
+// (2) generation is the # of jobs run() has started; a worker that has
+//     last worked on job # seen waits on wake until generation !=
+//     seen (or stopping is set). The members describing the current
+//     job (job, jobTasks, nextTask, busy) are only set by run() while
+//     no worker is working on a job.
+// (3) During a job, job references the task function, jobTasks is the
+//     # of tasks and nextTask the # of the next task to be taken (it
+//     goes past jobTasks once all are taken); busy is the # of workers
+//     that haven't finished with the job, and the last of them to
+//     finish wakes run() (which waits on done).
+//
+// DOCUMENTATION for the private IntSet member (helper) functions that
+// are defined here:
+//   int markParallel(const IntSet* probe, bool keepFound, char* keep,
+//                    std::vector<int>& chunkKept,
+//                    IntSetThreadPool& pool) const
+//     Pre:  keep has used elements; probe (if not 0) is not changed
+//           while the call runs.
+//     Post: keep[i] is 1 if data[i] is live and (probe is 0 or
+//           probe->contains(data[i]) == keepFound), otherwise 0; the
+//           positions have been split into chunksFor(used, pool)
+//           chunks (see chunkStart), chunkKept[c] is the # of 1's in
+//           chunk c, and the total # of 1's is returned.
+//   void appendMarked(const char* keep, const std::vector<int>& chunkKept,
+//                     IntSet& result, IntSetThreadPool& pool) const
+//     Pre:  keep and chunkKept are as markParallel left them (for the
+//           invoking IntSet); result has no index and no dead places,
+//           and room for the marked values after result.used.
+//     Post: The marked values have been appended to result.data in
+//           their order in data (each chunk copying to its own place,
+//           found from the chunk counts), and result.used and result's
+//           fingerprint account for them.
+//   void buildIndexParallel(IntSetThreadPool& pool)
+//     Pre:  As for syncIndex.
+//     Post: As for syncIndex.
+//     Note: The slots are split into ranges ("parts"); the values are
+//           first bucketed by the part of their home slot (in parallel
+//           by position chunk), then each part indexes its own values
+//           (in parallel by part), probing no further than the end of
+//           its range. The few values whose probe runs off the end of
+//           their part are indexed one by one afterwards; since slots
+//           are only ever filled, every probe run stays unbroken.
+
+#include "IntSetParallel.h"
+#include "IntSet.h"
+#include <vector>
+using namespace std;
+
+// ========================================================================
+// IntSetThreadPool
+// ========================================================================
+
+IntSetThreadPool::IntSetThreadPool(int threads)
+: job(0), jobTasks(0), nextTask(0), generation(0), busy(0),
+  stopping(false)
+{
+   if( threads <= 0 )
+      threads = static_cast<int>( thread::hardware_concurrency() );
+   if( threads <= 0 )                // (hardware_concurrency may not know)
+      threads = 1;
+
+   for( int t = 1; t < threads; t ++ )
+      workers.push_back(thread(&IntSetThreadPool::workerLoop, this));
+}
+
+// ========================================================================
+
+IntSetThreadPool::~IntSetThreadPool()
+{
+   {
+      lock_guard<mutex> guard(lock);
+      stopping = true;
+   }
+   wake.notify_all();
+   for( size_t t = 0; t < workers.size(); t ++ )
+      workers[t].join();
+}
+
+// ========================================================================
+
+int IntSetThreadPool::threads() const
+{
+   return static_cast<int>( workers.size() ) + 1;
+}
+
+// ========================================================================
+
+void IntSetThreadPool::run(int tasks, const function<void(int)>& task)
+
+// this function posts the job, takes tasks itself like a worker, and
+// then waits for the workers to finish the tasks they took
+{
+   if( tasks <= 0 )
+      return;
+
+   if( workers.empty() )
+   {
+      for( int i = 0; i < tasks; i ++ )
+         task(i);
+      return;
+   }
+
+   {
+      lock_guard<mutex> guard(lock);
+      job = &task;
+      jobTasks = tasks;
+      nextTask.store(0);
+      busy = static_cast<int>( workers.size() );
+      generation ++;
+   }
+   wake.notify_all();
+
+   takeTasks();
+
+   unique_lock<mutex> guard(lock);
+   done.wait(guard, [this]() { return busy == 0; });
+   job = 0;
+}
+
+// ========================================================================
+
+void IntSetThreadPool::workerLoop()
+{
+   unsigned long seen = 0;
+
+   unique_lock<mutex> guard(lock);
+   for( ;; )
+   {
+      wake.wait(guard, [this, &seen]()
+                { return stopping || generation != seen; });
+      if( stopping )
+         return;
+      seen = generation;
+
+      guard.unlock();
+      takeTasks();
+      guard.lock();
+
+      if( -- busy == 0 )
+         done.notify_one();
+   }
+}
+
+// ========================================================================
+
+void IntSetThreadPool::takeTasks()
+{
+   for( ;; )
+   {
+      int i = nextTask.fetch_add(1);
+      if( i >= jobTasks )
+         return;
+      (*job)(i);
+   }
+}
+
+// ========================================================================
+// IntSet parallel set operations
+// ========================================================================
+
+static int chunksFor(int numVals, const IntSetThreadPool& pool)
+
+// this function returns the # of chunks to split numVals positions into:
+// a few per thread (so a thread that is slowed down doesn't hold up the
+// rest), but not so many that a chunk has less than 4096 positions
+{
+   int chunks = 4 * pool.threads();
+   if( chunks > numVals / 4096 )
+      chunks = numVals / 4096;
+   return ( chunks > 0 ) ? chunks : 1;
+}
+
+// ========================================================================
+
+static int chunkStart(int numVals, int chunks, int c)
+
+// this function returns the first position of chunk c (c == chunks
+// gives numVals, the end of the last chunk)
+{
+   return static_cast<int>( static_cast<long long>(numVals) * c / chunks );
+}
+
+// ========================================================================
+
+int IntSet::markParallel(const IntSet* probe, bool keepFound, char* keep,
+                         vector<int>& chunkKept,
+                         IntSetThreadPool& pool) const
+{
+   int chunks = chunksFor(used, pool);
+   chunkKept.assign(chunks, 0);
+
+   pool.run(chunks, [this, probe, keepFound, keep, chunks, &chunkKept](int c)
+   {
+      int last = chunkStart(used, chunks, c + 1);
+      int kept = 0;
+      for( int i = chunkStart(used, chunks, c); i < last; i ++ )
+      {
+         bool k = isLive(i)
+                  && ( probe == 0 || probe->contains(data[i]) == keepFound );
+         keep[i] = k;
+         kept += k;
+      }
+      chunkKept[c] = kept;
+   });
+
+   int total = 0;
+   for( int c = 0; c < chunks; c ++ )
+      total += chunkKept[c];
+   return total;
+}
+
+// ========================================================================
+
+void IntSet::appendMarked(const char* keep, const vector<int>& chunkKept,
+                          IntSet& result, IntSetThreadPool& pool) const
+
+// this function turns the chunk counts into the place each chunk copies
+// to, and sums the fingerprint (being sums, the parts add up in any
+// order) chunk by chunk
+{
+   int chunks = static_cast<int>( chunkKept.size() );
+   vector<int> dest(chunks);
+   vector<unsigned int> sums(chunks);
+   vector<unsigned int> xors(chunks);
+
+   int at = result.used;
+   for( int c = 0; c < chunks; c ++ )
+   {
+      dest[c] = at;
+      at += chunkKept[c];
+   }
+
+   int* out = result.data;
+   pool.run(chunks, [this, keep, out, chunks, &dest, &sums, &xors](int c)
+   {
+      int last = chunkStart(used, chunks, c + 1);
+      int k = dest[c];
+      unsigned int sum = 0;
+      unsigned int x = 0;
+      for( int i = chunkStart(used, chunks, c); i < last; i ++ )
+      {
+         if( keep[i] )
+         {
+            out[k ++] = data[i];
+            unsigned int h = fingerprintOf(data[i]);
+            sum += h;
+            x ^= h;
+         }
+      }
+      sums[c] = sum;
+      xors[c] = x;
+   });
+
+   for( int c = 0; c < chunks; c ++ )
+   {
+      result.fpSum += sums[c];
+      result.fpXor ^= xors[c];
+   }
+   INTSET_COUNT(bytesCopied, ( at - result.used ) * sizeof(int));
+   result.used = at;
+   result.invalidateSorted();
+}
+
+// ========================================================================
+
+void IntSet::buildIndexParallel(IntSetThreadPool& pool)
+{
+   if( used < INDEX_THRESHOLD )
+      return;
+
+   int new_size = indexSizeFor(used);
+   int mask = new_size - 1;
+   int parts = 1;                   // a power of 2, >= 64 slots each
+   while( parts < 4 * pool.threads() && 64 * 2 * parts <= new_size )
+      parts *= 2;
+   int partSlots = new_size / parts;
+
+   delete [] index;
+   index = new int[new_size];
+   indexSize = new_size;
+   stats.indexBuilds ++;
+
+   int* slots = index;
+   pool.run(parts, [slots, partSlots](int p)
+   {
+      for( int s = p * partSlots; s < ( p + 1 ) * partSlots; s ++ )
+         slots[s] = -1;
+   });
+
+   // bucket the positions by part, in position order within each part
+   int chunks = chunksFor(used, pool);
+   vector<int> homes(used);
+   vector<int> at(chunks * parts, 0);        // at[c * parts + p]
+
+   pool.run(chunks, [this, mask, parts, partSlots, chunks, &homes, &at](int c)
+   {
+      int last = chunkStart(used, chunks, c + 1);
+      for( int i = chunkStart(used, chunks, c); i < last; i ++ )
+      {
+         homes[i] = homeSlot(data[i], mask);
+         at[c * parts + homes[i] / partSlots] ++;
+      }
+   });
+
+   vector<int> partStart(parts + 1);
+   int next = 0;
+   for( int p = 0; p < parts; p ++ )
+   {
+      partStart[p] = next;
+      for( int c = 0; c < chunks; c ++ )
+      {
+         int count = at[c * parts + p];
+         at[c * parts + p] = next;
+         next += count;
+      }
+   }
+   partStart[parts] = next;
+
+   vector<int> bucket(used);
+   pool.run(chunks, [this, parts, partSlots, chunks, &homes, &at, &bucket](int c)
+   {
+      int last = chunkStart(used, chunks, c + 1);
+      for( int i = chunkStart(used, chunks, c); i < last; i ++ )
+         bucket[at[c * parts + homes[i] / partSlots] ++] = i;
+   });
+
+   // index each part's values within the part's own slots
+   vector< vector<int> > spill(parts);
+   pool.run(parts, [slots, partSlots, &homes, &bucket, &partStart, &spill](int p)
+   {
+      int end = ( p + 1 ) * partSlots;
+      for( int k = partStart[p]; k < partStart[p + 1]; k ++ )
+      {
+         int pos = bucket[k];
+         int s = homes[pos];
+         while( s < end && slots[s] != -1 )
+            s ++;
+         if( s == end )
+            spill[p].push_back(pos);      // runs into the next part
+         else
+            slots[s] = pos;
+      }
+   });
+
+   for( int p = 0; p < parts; p ++ )
+   {
+      for( size_t k = 0; k < spill[p].size(); k ++ )
+         index[findSlot(data[spill[p][k]])] = spill[p][k];
+   }
+}
+
+// ========================================================================
+
+IntSet IntSet::unionWith(const IntSet& otherIntSet,
+                         IntSetThreadPool& pool) const
+
+// this function marks the live values of IntSet and the values of
+// otherIntSet that IntSet lacks, and then copies both over, IntSet's
+// first, as the serial version does
+{
+   if( used + otherIntSet.used < PARALLEL_MIN )
+      return unionWith(otherIntSet);
+
+   char* thisKeep = new char[used > 0 ? used : 1];
+   char* otherKeep = new char[otherIntSet.used > 0 ? otherIntSet.used : 1];
+   vector<int> thisKept;
+   vector<int> otherKept;
+
+   int totUnionVals = markParallel(0, true, thisKeep, thisKept, pool)
+                      + otherIntSet.markParallel(this, false, otherKeep,
+                                                 otherKept, pool);
+
+   IntSet tempArray( totUnionVals > capacity ? totUnionVals : capacity );
+   appendMarked(thisKeep, thisKept, tempArray, pool);
+   otherIntSet.appendMarked(otherKeep, otherKept, tempArray, pool);
+
+   delete [] thisKeep;
+   delete [] otherKeep;
+   tempArray.buildIndexParallel(pool);
+   return tempArray;
+}
+
+// ========================================================================
+
+IntSet IntSet::intersect(const IntSet& otherIntSet,
+                         IntSetThreadPool& pool) const
+{
+   if( used + otherIntSet.used < PARALLEL_MIN )
+      return intersect(otherIntSet);
+
+   char* keep = new char[used > 0 ? used : 1];
+   vector<int> kept;
+   markParallel(&otherIntSet, true, keep, kept, pool);
+
+   IntSet tempArray(capacity);
+   appendMarked(keep, kept, tempArray, pool);
+
+   delete [] keep;
+   tempArray.buildIndexParallel(pool);
+   return tempArray;
+}
+
+// ========================================================================
+
+IntSet IntSet::subtract(const IntSet& otherIntSet,
+                        IntSetThreadPool& pool) const
+{
+   if( used + otherIntSet.used < PARALLEL_MIN )
+      return subtract(otherIntSet);
+
+   char* keep = new char[used > 0 ? used : 1];
+   vector<int> kept;
+   markParallel(&otherIntSet, false, keep, kept, pool);
+
+   IntSet tempArray(capacity);
+   appendMarked(keep, kept, tempArray, pool);
+
+   delete [] keep;
+   tempArray.buildIndexParallel(pool);
+   return tempArray;
+}
@@ -0,0 +1,77 @@
+// FILE: IntSetParallel.h - header file for the IntSetThreadPool class
+// CLASS PROVIDED: IntSetThreadPool (a fixed set of worker threads that
+//                 the parallel IntSet set operations spread their work
+//                 over; see "PARALLEL SET OPERATIONS" in IntSet.h)
+//
+// A pool starts its threads once and keeps them waiting between jobs,
+// so that a set operation doesn't pay for starting threads each time. A
+// job is a # of tasks, numbered 0 .. tasks - 1; the workers (and the
+// calling thread, which counts as one of the pool's threads) take tasks
+// in turn until none is left, and run() returns when all are done.
+// Which thread runs which task is not fixed, so tasks must not depend
+// on each other; they are meant to each work on their own part of the
+// data (a "partition"), writing their results to their own place.
+//
+// The member functions of the pool are meant to be called from one
+// thread at a time (the thread that owns the pool).
+//
+// CONSTRUCTOR
+//   explicit IntSetThreadPool(int threads = 0)
+//     Pre:  threads >= 0
+//     Post: The pool has been set up to run jobs on threads threads
+//           (the calling thread and threads - 1 workers), or on one
+//           thread per hardware thread if threads is 0.
+//
+// DESTRUCTOR
+//   ~IntSetThreadPool()
+//     Pre:  No job is running.
+//     Post: The worker threads have been stopped and joined.
+//
+// MEMBER FUNCTIONS
+//   int threads() const
+//     Post: The # of threads jobs are run on is returned.
+//   void run(int tasks, const std::function<void(int)>& task)
+//     Pre:  tasks >= 0; task doesn't call run() on the same pool.
+//     Post: task(i) has been called once for each i in 0 .. tasks - 1,
+//           spread over the pool's threads, and all calls have
+//           returned.
+//
+// VALUE SEMANTICS
+//   An IntSetThreadPool may not be copied or assigned.
+
+#ifndef INT_SET_PARALLEL_H
+#define INT_SET_PARALLEL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class IntSetThreadPool
+{
+public:
+   explicit IntSetThreadPool(int threads = 0);
+   ~IntSetThreadPool();
+   IntSetThreadPool(const IntSetThreadPool&) = delete;
+   IntSetThreadPool& operator=(const IntSetThreadPool&) = delete;
+   int threads() const;
+   void run(int tasks, const std::function<void(int)>& task);
+
+private:
+   std::vector<std::thread> workers;
+   std::mutex lock;
+   std::condition_variable wake;     // workers wait here for a job
+   std::condition_variable done;     // run() waits here for the workers
+   const std::function<void(int)>* job;
+   int jobTasks;
+   std::atomic<int> nextTask;
+   unsigned long generation;         // # of jobs started so far
+   int busy;                         // # of workers still on the job
+   bool stopping;
+   void workerLoop();
+   void takeTasks();
+};
+
+#endif
@@ -0,0 +1,469 @@
+// FILE: IntSetReplay.cpp
+//       A non-interactive replay engine for load-testing IntSet: it
+//       runs a log of (possibly millions of) operations on many named
+//       IntSet's, timing each one, and checks the results against the
+//       checksum recorded in the log.
+//
+// DESCRIPTION:
+// Assign02.cpp drives IntSet one menu command at a time from cin, which
+// is fine for the short a2test*.in scripts but not for load tests. A
+// replay log is a text file with one operation per line (blank lines
+// and lines starting with '#' are skipped); sets are named by any word
+// and are created, empty, when first named:
+//   a SET VALUE        SET.add(VALUE)
+//   r SET VALUE        SET.remove(VALUE)
+//   c SET VALUE        SET.contains(VALUE)
+//   u DEST SET1 SET2   DEST = SET1.unionWith(SET2)
+//   i DEST SET1 SET2   DEST = SET1.intersect(SET2)
+//   s DEST SET1 SET2   DEST = SET1.subtract(SET2)
+//   e SET1 SET2        SET1 == SET2
+//   z SET              SET.reset()
+//   x CHECKSUM         the expected checksum (in hex) of the whole log
+// The whole log is parsed before anything is run, so only the
+// operations themselves are timed. The checksum folds in every result:
+// the bool returned by add, remove, contains and ==, and for the set
+// operations the size of the result and the sum of a hash of each of its
+// values (which doesn't depend on membership order); the hashing is
+// done outside the timing. Each operation's time goes into a histogram
+// for its type, with one bucket per power of 2 nanoseconds, from which
+// the count, mean, 50th, 90th and 99th percentiles (as the upper end of
+// their bucket) and maximum are printed to cout, followed by the
+// throughput and the checksums; the exit status is EXIT_FAILURE if the
+// log's checksum doesn't match. (Each time includes the cost of reading
+// the clock, some tens of nanoseconds.)
+//
+// "replay gen" writes a random log (to cout), with its checksum worked
+// out by running it on std::unordered_set's instead, so a replay of it
+// also checks IntSet against an independent implementation. Its values
+// are drawn from [0, GEN_VALUES), so the sets stay at a few thousand
+// values at most.
+// Usage: replay run LOG_FILE          (LOG_FILE "-" reads cin)
+//        replay gen NUM_OPS [NUM_SETS [SEED]]
+
+#include "IntSet.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+using namespace std;
+
+const int GEN_VALUES = 4096;
+const int DEFAULT_NUM_SETS = 16;
+const int BUCKETS = 48;                // up to 2^48 ns, over 3 days
+
+enum OpType { ADD, REMOVE, CONTAINS, UNION, INTERSECT, SUBTRACT, EQUAL,
+              RESET, NUM_OP_TYPES };
+const char OP_CODES[] = "arcuisez";
+const char* const OP_NAMES[] = { "add", "remove", "contains", "union",
+                                 "intersect", "subtract", "equal",
+                                 "reset" };
+
+struct Op
+{
+   OpType type;
+   int set1;                           // the set changed or asked
+   int set2;                           // (or DEST, SET1 and SET2 for
+   int set3;                           //  the set operations)
+   int value;
+};
+
+struct Log
+{
+   vector<Op> ops;
+   vector<string> setNames;            // indexed by set #
+   bool hasChecksum;
+   unsigned long long checksum;
+};
+
+struct Histogram
+{
+   unsigned long long counts[BUCKETS];
+   unsigned long long total;
+   double sumNs;
+   double maxNs;
+};
+
+bool parseLog(istream& in, Log& log);
+// Pre:  (none)
+// Post: The log read from in has been stored in log and true returned;
+//       if a line is not valid, a message naming it has been written to
+//       cerr and false returned.
+
+void runLog(const Log& log, Histogram hist[NUM_OP_TYPES],
+            unsigned long long& checksum, double& totalSeconds);
+// Pre:  log was filled by parseLog.
+// Post: The operations of log have been run on one IntSet per set
+//       name; each time has been added to hist[its type] (all of which
+//       start out cleared), the checksum of the results stored in
+//       checksum, and the time of the whole run (hashing included) in
+//       totalSeconds.
+
+void generateLog(long numOps, int numSets, unsigned int seed, ostream& out);
+// Pre:  numOps >= 0; numSets >= 1
+// Post: A random log of numOps operations on numSets sets, ending with
+//       its checksum, has been written to out.
+
+void printReport(const Histogram hist[NUM_OP_TYPES], double totalSeconds,
+                 ostream& out);
+// Post: The histograms and the throughput have been written to out.
+
+unsigned long long mixValue(int anInt);
+// Post: A 64-bit hash of anInt is returned.
+
+unsigned long long fold(unsigned long long checksum, unsigned long long x);
+// Post: x folded into checksum (FNV-1a style) is returned.
+
+int main(int argc, char* argv[])
+{
+   if( argc >= 3 && strcmp(argv[1], "gen") == 0 )
+   {
+      long numOps = atol(argv[2]);
+      int numSets = ( argc > 3 ) ? atoi(argv[3]) : DEFAULT_NUM_SETS;
+      unsigned int seed = ( argc > 4 ) ? strtoul(argv[4], 0, 10) : 1;
+      if( numOps < 0 || numSets < 1 )
+      {
+         cerr << "replay gen: NUM_OPS must be >= 0 and NUM_SETS >= 1" << endl;
+         return EXIT_FAILURE;
+      }
+      generateLog(numOps, numSets, seed, cout);
+      return EXIT_SUCCESS;
+   }
+
+   if( argc != 3 || strcmp(argv[1], "run") != 0 )
+   {
+      cerr << "usage: replay run LOG_FILE" << endl
+           << "       replay gen NUM_OPS [NUM_SETS [SEED]]" << endl;
+      return EXIT_FAILURE;
+   }
+
+   Log log;
+   bool parsed;
+   if( strcmp(argv[2], "-") == 0 )
+      parsed = parseLog(cin, log);
+   else
+   {
+      ifstream in(argv[2]);
+      if( !in )
+      {
+         cerr << "replay: can't open " << argv[2] << endl;
+         return EXIT_FAILURE;
+      }
+      parsed = parseLog(in, log);
+   }
+   if( !parsed )
+      return EXIT_FAILURE;
+
+   Histogram hist[NUM_OP_TYPES];
+   unsigned long long checksum = 0;
+   double totalSeconds = 0;
+   runLog(log, hist, checksum, totalSeconds);
+   printReport(hist, totalSeconds, cout);
+
+   cout << hex << setfill('0') << "checksum " << setw(16) << checksum;
+   if( !log.hasChecksum )
+   {
+      cout << " (the log has none to check)" << endl;
+      return EXIT_SUCCESS;
+   }
+   bool ok = ( checksum == log.checksum );
+   cout << ", expected " << setw(16) << log.checksum
+        << ( ok ? ": OK" : ": MISMATCH" ) << endl;
+   return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+bool parseLog(istream& in, Log& log)
+{
+   string text((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+   unordered_map<string, int> setNumbers;
+   log.ops.clear();
+   log.setNames.clear();
+   log.hasChecksum = false;
+   log.checksum = 0;
+
+   const char* p = text.c_str();
+   long lineNum = 0;
+   while( *p != '\0' )
+   {
+      const char* end = strchr(p, '\n');
+      if( end == 0 )
+         end = p + strlen(p);
+      string line(p, end);
+      p = ( *end == '\n' ) ? end + 1 : end;
+      lineNum ++;
+
+      // split the line into words (a fifth is only read to reject it)
+      string words[5];
+      int numWords = 0;
+      size_t at = 0;
+      while( numWords < 5 )
+      {
+         at = line.find_first_not_of(" \t\r", at);
+         if( at == string::npos )
+            break;
+         size_t stop = line.find_first_of(" \t\r", at);
+         words[numWords ++] = line.substr(at, stop - at);
+         at = stop;
+      }
+      if( numWords == 0 || words[0][0] == '#' )
+         continue;
+
+      const char* code = strchr(OP_CODES, words[0][0]);
+      bool ok = ( words[0].size() == 1 && ( code != 0 || words[0] == "x" ) );
+      Op op;
+      op.set1 = op.set2 = op.set3 = -1;
+      op.value = 0;
+      if( ok && words[0] == "x" )
+      {
+         char* stop = 0;
+         log.checksum = strtoull(words[1].c_str(), &stop, 16);
+         log.hasChecksum = true;
+         ok = ( numWords == 2 && *stop == '\0' );
+         if( ok )
+            continue;
+      }
+      else if( ok )
+      {
+         op.type = static_cast<OpType>( code - OP_CODES );
+         int sets = ( op.type == RESET ) ? 1
+                    : ( op.type == EQUAL ) ? 2
+                    : ( op.type <= CONTAINS ) ? 1 : 3;
+         bool hasValue = ( op.type <= CONTAINS );
+         ok = ( numWords == 1 + sets + hasValue );
+         for( int w = 1; ok && w <= sets; w ++ )
+         {
+            unordered_map<string, int>::iterator found =
+               setNumbers.find(words[w]);
+            int num;
+            if( found != setNumbers.end() )
+               num = found->second;
+            else
+            {
+               num = static_cast<int>( log.setNames.size() );
+               setNumbers[words[w]] = num;
+               log.setNames.push_back(words[w]);
+            }
+            ( w == 1 ? op.set1 : w == 2 ? op.set2 : op.set3 ) = num;
+         }
+         if( ok && hasValue )
+         {
+            char* stop = 0;
+            long v = strtol(words[2].c_str(), &stop, 10);
+            ok = ( *stop == '\0' && v == static_cast<int>(v) );
+            op.value = static_cast<int>(v);
+         }
+      }
+
+      if( !ok )
+      {
+         cerr << "replay: line " << lineNum << " is not valid: " << line
+              << endl;
+         return false;
+      }
+      log.ops.push_back(op);
+   }
+   return true;
+}
+
+void runLog(const Log& log, Histogram hist[NUM_OP_TYPES],
+            unsigned long long& checksum, double& totalSeconds)
+{
+   typedef chrono::steady_clock Clock;
+
+   memset(hist, 0, NUM_OP_TYPES * sizeof(Histogram));
+   vector<IntSet> sets(log.setNames.size());
+   checksum = 0;
+
+   Clock::time_point runStart = Clock::now();
+   for( size_t n = 0; n < log.ops.size(); n ++ )
+   {
+      const Op& op = log.ops[n];
+      bool result = false;
+
+      Clock::time_point start = Clock::now();
+      switch( op.type )
+      {
+         case ADD:
+            result = sets[op.set1].add(op.value);
+            break;
+         case REMOVE:
+            result = sets[op.set1].remove(op.value);
+            break;
+         case CONTAINS:
+            result = sets[op.set1].contains(op.value);
+            break;
+         case UNION:
+            sets[op.set1] = sets[op.set2].unionWith(sets[op.set3]);
+            break;
+         case INTERSECT:
+            sets[op.set1] = sets[op.set2].intersect(sets[op.set3]);
+            break;
+         case SUBTRACT:
+            sets[op.set1] = sets[op.set2].subtract(sets[op.set3]);
+            break;
+         case EQUAL:
+            result = ( sets[op.set1] == sets[op.set2] );
+            break;
+         default:
+            sets[op.set1].reset();
+            break;
+      }
+      double ns = chrono::duration<double, nano>(Clock::now() - start).count();
+
+      Histogram& h = hist[op.type];
+      unsigned long long whole = static_cast<unsigned long long>(ns);
+      int bucket = ( whole == 0 ) ? 0 : 63 - __builtin_clzll(whole);
+      h.counts[bucket < BUCKETS ? bucket : BUCKETS - 1] ++;
+      h.total ++;
+      h.sumNs += ns;
+      if( ns > h.maxNs )
+         h.maxNs = ns;
+
+      if( op.type == UNION || op.type == INTERSECT || op.type == SUBTRACT )
+      {
+         const IntSet& r = sets[op.set1];
+         unsigned long long sum = 0;
+         for( IntSet::const_iterator v = r.begin(); v != r.end(); ++ v )
+            sum += mixValue(*v);
+         checksum = fold(fold(checksum, r.size()), sum);
+      }
+      else if( op.type != RESET )
+         checksum = fold(checksum, result);
+   }
+   totalSeconds = chrono::duration<double>(Clock::now() - runStart).count();
+}
+
+void generateLog(long numOps, int numSets, unsigned int seed, ostream& out)
+{
+   vector< unordered_set<int> > sets(numSets);
+   unsigned long long checksum = 0;
+   unsigned int x = seed * 2654435761U + 1;             // xorshift
+
+   out << "# IntSetReplay log: " << numOps << " operations on " << numSets
+       << " sets (replay gen " << numOps << ' ' << numSets << ' ' << seed
+       << ")\n";
+   for( long n = 0; n < numOps; n ++ )
+   {
+      x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+      unsigned int pick = x % 1000;
+      int s1 = ( x >> 10 ) % numSets;
+      int s2 = ( x >> 15 ) % numSets;
+      int s3 = ( x >> 20 ) % numSets;
+      x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+      int value = x % GEN_VALUES;
+
+      // mostly adds, removes and lookups; the O(n) set operations and
+      // == (and the odd reset) make up about 5%
+      OpType type = ( pick < 450 ) ? ADD : ( pick < 700 ) ? REMOVE
+                    : ( pick < 950 ) ? CONTAINS : ( pick < 962 ) ? UNION
+                    : ( pick < 974 ) ? INTERSECT : ( pick < 986 ) ? SUBTRACT
+                    : ( pick < 998 ) ? EQUAL : RESET;
+      out << OP_CODES[type];
+      switch( type )
+      {
+         case ADD:
+            checksum = fold(checksum, sets[s1].insert(value).second);
+            out << " s" << s1 << ' ' << value << '\n';
+            break;
+         case REMOVE:
+            checksum = fold(checksum, sets[s1].erase(value) > 0);
+            out << " s" << s1 << ' ' << value << '\n';
+            break;
+         case CONTAINS:
+            checksum = fold(checksum, sets[s1].count(value) > 0);
+            out << " s" << s1 << ' ' << value << '\n';
+            break;
+         case UNION:
+         case INTERSECT:
+         case SUBTRACT:
+         {
+            unordered_set<int> result;
+            if( type == UNION )
+               result = sets[s2];
+            const unordered_set<int>& from = ( type == UNION ) ? sets[s3]
+                                                               : sets[s2];
+            for( unordered_set<int>::const_iterator v = from.begin();
+                 v != from.end(); ++ v )
+            {
+               if( type == UNION || ( sets[s3].count(*v) > 0 ) == ( type == INTERSECT ) )
+                  result.insert(*v);
+            }
+            sets[s1].swap(result);
+
+            unsigned long long sum = 0;
+            for( unordered_set<int>::const_iterator v = sets[s1].begin();
+                 v != sets[s1].end(); ++ v )
+               sum += mixValue(*v);
+            checksum = fold(fold(checksum, sets[s1].size()), sum);
+            out << " s" << s1 << " s" << s2 << " s" << s3 << '\n';
+            break;
+         }
+         case EQUAL:
+            checksum = fold(checksum, sets[s1] == sets[s2]);
+            out << " s" << s1 << " s" << s2 << '\n';
+            break;
+         default:
+            sets[s1].clear();
+            out << " s" << s1 << '\n';
+            break;
+      }
+   }
+   out << "x " << hex << checksum << dec << '\n';
+}
+
+void printReport(const Histogram hist[NUM_OP_TYPES], double totalSeconds,
+                 ostream& out)
+{
+   const double QUANTILES[] = { 0.50, 0.90, 0.99 };
+
+   out << left << setw(10) << "op" << right << setw(12) << "count"
+       << setw(12) << "mean_ns" << setw(12) << "p50_ns<=" << setw(12)
+       << "p90_ns<=" << setw(12) << "p99_ns<=" << setw(14) << "max_ns"
+       << '\n' << fixed << setprecision(0);
+
+   unsigned long long totalOps = 0;
+   for( int t = 0; t < NUM_OP_TYPES; t ++ )
+   {
+      const Histogram& h = hist[t];
+      totalOps += h.total;
+      if( h.total == 0 )
+         continue;
+
+      out << left << setw(10) << OP_NAMES[t] << right << setw(12) << h.total
+          << setw(12) << h.sumNs / h.total;
+      int bucket = 0;
+      unsigned long long below = h.counts[0];
+      for( int q = 0; q < 3; q ++ )
+      {
+         while( below < QUANTILES[q] * h.total && bucket < BUCKETS - 1 )
+            below += h.counts[++ bucket];
+         out << setw(12) << static_cast<double>( 2ULL << bucket );
+      }
+      out << setw(14) << h.maxNs << '\n';
+   }
+
+   out << totalOps << " operations in " << setprecision(3) << totalSeconds
+       << " s (" << setprecision(0)
+       << ( totalSeconds > 0 ? totalOps / totalSeconds : 0 )
+       << " ops/s)" << endl;
+}
+
+unsigned long long mixValue(int anInt)
+{
+   unsigned long long z = static_cast<unsigned int>(anInt)
+                          + 0x9e3779b97f4a7c15ULL;
+   z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+   z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+   return z ^ ( z >> 31 );
+}
+
+unsigned long long fold(unsigned long long checksum, unsigned long long x)
+{
+   return ( checksum ^ x ) * 0x100000001b3ULL;
+}
@@ -0,0 +1,211 @@
+// FILE: IntSetSketch.cpp
+//       Implementation file for the IntSetSketch class
+//       (See IntSetSketch.h for documentation.)
+// INVARIANT for the IntSetSketch class:
+// (1) bits is the precision and k the # of MinHash hashes configured;
+//     registers has 2^bits elements.
+// (2) For each value v recorded since the sketch was cleared, with h
+//     the 64-bit hash of v (see hash64): register h >> (64 - bits) is
+//     at least the rank of h, i.e. 1 + the # of leading zeros of the
+//     other 64 - bits bits of h (64 - bits + 1 if they are all 0), and
+//     each register is the highest such rank (0 if none).
+// (3) mins holds the (up to) k smallest distinct hashes of the values
+//     recorded, in ascending order.
+// (4) removed is the # of noteRemoval calls since the sketch was
+//     cleared.
+
+#include "IntSetSketch.h"
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+// ========================================================================
+
+static unsigned long long hash64(int anInt)
+
+// this function scrambles anInt into 64 well-mixed bits (the SplitMix64
+// finalizer, as in IntSetBloom.cpp)
+{
+   unsigned long long z = static_cast<unsigned int>(anInt)
+                          + 0x9e3779b97f4a7c15ULL;
+   z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+   z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+   return z ^ ( z >> 31 );
+}
+
+// ========================================================================
+
+IntSetSketch::IntSetSketch(int precision, int minHashes)
+: registers(static_cast<size_t>(1) << precision, 0),
+  bits(precision), k(minHashes), removed(0)
+{
+   mins.reserve(k);
+}
+
+// ========================================================================
+
+void IntSetSketch::clear()
+{
+   fill(registers.begin(), registers.end(), 0);
+   mins.clear();
+   removed = 0;
+}
+
+// ========================================================================
+
+void IntSetSketch::insert(int anInt)
+
+// this function raises the value's register to its rank, and puts its
+// hash into mins if it is new and among the k smallest (most hashes are
+// turned away by the one comparison with the largest of mins)
+{
+   unsigned long long h = hash64(anInt);
+
+   unsigned long long rest = h << bits;
+   int rank = ( rest == 0 ) ? 64 - bits + 1 : __builtin_clzll(rest) + 1;
+   unsigned char& reg = registers[h >> ( 64 - bits )];
+   if( rank > reg )
+      reg = static_cast<unsigned char>(rank);
+
+   if( static_cast<int>( mins.size() ) == k && h >= mins.back() )
+      return;
+   vector<unsigned long long>::iterator at =
+      lower_bound(mins.begin(), mins.end(), h);
+   if( at != mins.end() && *at == h )
+      return;
+   mins.insert(at, h);
+   if( static_cast<int>( mins.size() ) > k )
+      mins.pop_back();
+}
+
+// ========================================================================
+
+void IntSetSketch::noteRemoval()
+{
+   removed ++;
+}
+
+// ========================================================================
+
+bool IntSetSketch::needsRebuild(int liveValues) const
+{
+   return ( 4 * removed > liveValues + 64 );
+}
+
+// ========================================================================
+
+bool IntSetSketch::compatible(const IntSetSketch& other) const
+{
+   return ( bits == other.bits && k == other.k );
+}
+
+// ========================================================================
+
+void IntSetSketch::merge(const IntSetSketch& other)
+{
+   for( size_t r = 0; r < registers.size(); r ++ )
+      registers[r] = max(registers[r], other.registers[r]);
+
+   vector<unsigned long long> both(mins.size() + other.mins.size());
+   both.erase(set_union(mins.begin(), mins.end(),
+                        other.mins.begin(), other.mins.end(), both.begin()),
+              both.end());
+   if( static_cast<int>( both.size() ) > k )
+      both.resize(k);
+   mins.swap(both);
+   removed += other.removed;
+}
+
+// ========================================================================
+
+double IntSetSketch::estimateFrom(const unsigned char* regs1,
+                                  const unsigned char* regs2) const
+
+// this function returns the HyperLogLog estimate for the register-by-
+// register maximum of regs1 and regs2 (or for regs1 alone if regs2 is
+// 0): the harmonic mean of 2^register, scaled, or "linear counting"
+// from the # of empty registers when that is more accurate (for small
+// sets)
+{
+   int m = static_cast<int>( registers.size() );
+   double sum = 0;
+   int zeros = 0;
+   for( int r = 0; r < m; r ++ )
+   {
+      int reg = ( regs2 != 0 && regs2[r] > regs1[r] ) ? regs2[r] : regs1[r];
+      sum += ldexp(1.0, -reg);
+      zeros += ( reg == 0 );
+   }
+
+   double alpha = 0.7213 / ( 1 + 1.079 / m );
+   double estimate = alpha * m * m / sum;
+   if( estimate <= 2.5 * m && zeros > 0 )
+      estimate = m * log(static_cast<double>(m) / zeros);
+   return estimate;
+}
+
+// ========================================================================
+
+double IntSetSketch::cardinality() const
+{
+   return estimateFrom(&registers[0], 0);
+}
+
+// ========================================================================
+
+double IntSetSketch::unionCardinality(const IntSetSketch& other) const
+{
+   return estimateFrom(&registers[0], &other.registers[0]);
+}
+
+// ========================================================================
+
+double IntSetSketch::jaccard(const IntSetSketch& other) const
+
+// this function walks the two lists of smallest hashes together, taking
+// the (up to) k smallest distinct hashes of the union, and counts those
+// that are in both lists
+{
+   size_t i = 0;
+   size_t j = 0;
+   int taken = 0;
+   int inBoth = 0;
+   while( taken < k && ( i < mins.size() || j < other.mins.size() ) )
+   {
+      if( j == other.mins.size()
+          || ( i < mins.size() && mins[i] < other.mins[j] ) )
+         i ++;
+      else if( i == mins.size() || other.mins[j] < mins[i] )
+         j ++;
+      else
+      {
+         i ++;
+         j ++;
+         inBoth ++;
+      }
+      taken ++;
+   }
+   return ( taken == 0 ) ? 1 : static_cast<double>(inBoth) / taken;
+}
+
+// ========================================================================
+
+int IntSetSketch::precision() const
+{
+   return bits;
+}
+
+// ========================================================================
+
+int IntSetSketch::minHashes() const
+{
+   return k;
+}
+
+// ========================================================================
+
+int IntSetSketch::bytes() const
+{
+   return static_cast<int>( registers.size()
+                            + mins.capacity() * sizeof(unsigned long long) );
+}
@@ -0,0 +1,111 @@
+// FILE: IntSetSketch.h - header file for the IntSetSketch class
+// CLASS PROVIDED: IntSetSketch (a HyperLogLog and a MinHash sketch of a
+//                 set of int values, which IntSet can keep up to date
+//                 so that the size of the union of two IntSet's, and
+//                 their Jaccard similarity, can be estimated without
+//                 looking at their values)
+//
+// Both sketches are fixed-size summaries of the values inserted into
+// them (the same value inserted twice counts once), built from a 64-bit
+// hash of each value:
+//   HyperLogLog - 2^precision one-byte registers; each value goes to
+//                 the register picked by the top precision bits of its
+//                 hash, which keeps the highest "rank" (1 + the # of
+//                 leading zero bits of the rest of the hash) seen. The
+//                 # of distinct values is estimated from the registers
+//                 with a relative error of about 1.04 / sqrt(2^precision)
+//                 (1.6% for the default precision of 12, in 4 KB).
+//   MinHash     - the minHashes smallest distinct hashes seen (a
+//                 "bottom-k" MinHash). The Jaccard similarity |A & B| /
+//                 |A | B| of two sets is estimated as the fraction of
+//                 the smallest minHashes hashes of A | B (found from the
+//                 two sketches alone) that are in both sketches, with a
+//                 standard error of at most 0.5 / sqrt(minHashes) (3% for
+//                 the default of 256, in 2 KB).
+// Two sketches with the same parameters can be merged, giving exactly
+// the sketch of the union of their sets; the estimates between two
+// sketches take O(2^precision + minHashes) time, however big the sets.
+//
+// Neither sketch can forget a value, so values removed from the set
+// stay in them until they are rebuilt; like IntBloomFilter, a sketch
+// counts the removals it is told of, so that its owner can rebuild it
+// once they are a good part of the set (see needsRebuild).
+//
+// CONSTRUCTOR
+//   IntSetSketch(int precision = 12, int minHashes = 256)
+//     Pre:  4 <= precision <= 18; minHashes >= 1
+//     Post: The sketch is empty, with 2^precision HyperLogLog registers
+//           and room for minHashes MinHash hashes.
+//
+// MEMBER FUNCTIONS
+//   void clear()
+//     Post: The sketch is empty (with the same parameters).
+//   void insert(int anInt)
+//     Post: anInt has been recorded in the sketch.
+//   void noteRemoval()
+//     Post: The sketch has been told that one recorded value has left
+//           the set (it is still in the sketch).
+//   bool needsRebuild(int liveValues) const
+//     Post: True is returned if the removed values exceed a quarter of
+//           liveValues, i.e. if the estimates are well off.
+//   bool compatible(const IntSetSketch& other) const
+//     Post: True is returned if other has the same precision and
+//           minHashes as the invoking sketch, otherwise false.
+//   void merge(const IntSetSketch& other)
+//     Pre:  compatible(other)
+//     Post: The invoking sketch is the sketch of the union of its
+//           values and other's.
+//   double cardinality() const
+//     Post: The estimated # of distinct values recorded is returned.
+//   double unionCardinality(const IntSetSketch& other) const
+//     Pre:  compatible(other)
+//     Post: The estimated # of distinct values recorded in either
+//           sketch is returned (as merging would give, but without
+//           changing either sketch).
+//   double jaccard(const IntSetSketch& other) const
+//     Pre:  compatible(other)
+//     Post: The estimated Jaccard similarity of the values recorded in
+//           the two sketches is returned (1 if both are empty).
+//   int precision() const
+//   int minHashes() const
+//   int bytes() const
+//     Post: The configured parameters, or the # of bytes of registers
+//           and hashes the sketch uses, are returned.
+//
+// VALUE SEMANTICS
+//   Assignment and the copy constructor may be used with IntSetSketch
+//   objects.
+
+#ifndef INT_SET_SKETCH_H
+#define INT_SET_SKETCH_H
+
+#include <vector>
+
+class IntSetSketch
+{
+public:
+   IntSetSketch(int precision = 12, int minHashes = 256);
+   void clear();
+   void insert(int anInt);
+   void noteRemoval();
+   bool needsRebuild(int liveValues) const;
+   bool compatible(const IntSetSketch& other) const;
+   void merge(const IntSetSketch& other);
+   double cardinality() const;
+   double unionCardinality(const IntSetSketch& other) const;
+   double jaccard(const IntSetSketch& other) const;
+   int precision() const;
+   int minHashes() const;
+   int bytes() const;
+
+private:
+   std::vector<unsigned char> registers;   // HyperLogLog
+   std::vector<unsigned long long> mins;   // MinHash, ascending
+   int bits;                   // precision
+   int k;                      // minHashes
+   int removed;                // # of values removed since cleared
+   double estimateFrom(const unsigned char* regs1,
+                       const unsigned char* regs2) const;
+};
+
+#endif
@@ -0,0 +1,61 @@
+// FILE: IntSetStats.h - the opt-in operation counters of IntSet
+// PROVIDED: IntSetCounters (the counters themselves) and the macros
+//           INTSET_COUNT(field, n) and INTSET_COUNT_IN(owner, field, n),
+//           which IntSet's member functions use to count their work
+//           (see IntSet::OpStats in IntSet.h)
+//
+// The counters exist only when the program is compiled with
+// INTSET_STATS defined (e.g., make STATS=-DINTSET_STATS, which passes
+// it to every file that uses IntSet): otherwise IntSetCounters is not
+// defined, IntSet has no counter members, and INTSET_COUNT expands to
+// nothing (its arguments are not even evaluated), so IntSet is exactly
+// as fast and as big as without the feature. All the files of a
+// program must agree on INTSET_STATS, since it changes IntSet's layout.
+//
+// The counters are atomic (incremented with relaxed ordering), since
+// const operations (contains, the set operations) count too, and may
+// run on the same IntSet in several threads at once (see
+// ConcurrentIntSet.h and IntSetParallel.h).
+//
+// INTSET_COUNT(field, n)
+//   Pre:  Used inside a (const or non-const) member function of
+//         IntSet; field is comparisons, moves, reallocations or
+//         bytesCopied.
+//   Post: n has been added to field in the invoking IntSet's counters
+//         and in the global counters (if INTSET_STATS is defined).
+// INTSET_COUNT_IN(owner, field, n)
+//   Pre:  Used inside a member function of IntSet (static ones too);
+//         owner is an IntSet.
+//   Post: As INTSET_COUNT, but counted for owner.
+
+#ifndef INT_SET_STATS_H
+#define INT_SET_STATS_H
+
+#ifdef INTSET_STATS
+
+#include <atomic>
+
+struct IntSetCounters
+{
+   std::atomic<unsigned long long> comparisons;
+   std::atomic<unsigned long long> moves;
+   std::atomic<unsigned long long> reallocations;
+   std::atomic<unsigned long long> bytesCopied;
+   IntSetCounters()
+   : comparisons(0), moves(0), reallocations(0), bytesCopied(0) { }
+};
+
+#define INTSET_COUNT_IN(owner, field, n)                                   \
+   ( (owner).opCounters.field.fetch_add((n), std::memory_order_relaxed),   \
+     IntSet::globalCounters.field.fetch_add((n), std::memory_order_relaxed) )
+
+#define INTSET_COUNT(field, n) INTSET_COUNT_IN(*this, field, n)
+
+#else
+
+#define INTSET_COUNT_IN(owner, field, n) ( static_cast<void>(0) )
+#define INTSET_COUNT(field, n) ( static_cast<void>(0) )
+
+#endif
+
+#endif
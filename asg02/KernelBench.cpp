@@ -0,0 +1,109 @@
+// FILE: KernelBench.cpp
+//       A benchmark comparing the scalar, SSE4.2 and AVX2 versions of
+//       the findInt kernel (see IntSetKernels.h) on arrays of the sizes
+//       IntSet scans (small sets and small set operations).
+//
+// DESCRIPTION:
+// For each array size, the same mix of lookups (half hits at random
+// positions, half misses) is run through each version the CPU supports
+// and the average time per lookup is printed to cout, along with the
+// speedup over the scalar version. The versions must agree on every
+// lookup; a disagreement is reported and the program fails.
+
+#include "IntSetKernels.h"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <ctime>
+using namespace std;
+
+typedef int (*FindFn)(const int*, int, int);
+
+double time_kernel(FindFn fn, const int* data, int n,
+                   const int* keys, int numKeys, int reps, long& checksum);
+// Pre:  data[0..n - 1] and keys[0..numKeys - 1] are valid.
+// Post: fn has been called for every key, reps times over; the sum of
+//       all the positions returned has been added to checksum, and the
+//       average # of nanoseconds per call is returned.
+
+int main()
+{
+   const int SIZES[] = { 4, 8, 16, 32, 64, 128, 256, 512, 1024, 4096 };
+   const int NUM_SIZES = sizeof(SIZES) / sizeof(SIZES[0]);
+   const int NUM_KEYS = 1024;
+   const long WORK = 50000000L;       // ~ # of ints compared per version
+
+   srand(3358);
+
+   cout << "dispatched kernel: " << kernelName() << endl;
+   cout << setw(6) << "n" << setw(12) << "scalar ns"
+        << setw(12) << "sse4.2 ns" << setw(10) << "speedup"
+        << setw(12) << "avx2 ns" << setw(10) << "speedup" << endl;
+
+   for( int s = 0; s < NUM_SIZES; s ++ )
+   {
+      int n = SIZES[s];
+      int* data = new int[n];
+      int* keys = new int[NUM_KEYS];
+
+      for( int i = 0; i < n; i ++ )          // distinct, like an IntSet
+         data[i] = 2 * i + 1;
+      for( int i = 0; i < n; i ++ )          // in "membership" order
+      {
+         int j = rand() % n;
+         int t = data[i]; data[i] = data[j]; data[j] = t;
+      }
+      for( int k = 0; k < NUM_KEYS; k ++ )   // odd = hit, even = miss
+         keys[k] = ( k % 2 == 0 ) ? data[rand() % n] : 2 * ( rand() % n );
+
+      int reps = static_cast<int>( WORK / ( static_cast<long>(n) * NUM_KEYS ) );
+      if( reps < 1 )
+         reps = 1;
+
+      long scalarSum = 0;
+      double scalarNs = time_kernel(findIntScalar, data, n, keys, NUM_KEYS,
+                                    reps, scalarSum);
+      cout << setw(6) << n << fixed << setprecision(2)
+           << setw(12) << scalarNs;
+
+      FindFn versions[2] = { findIntSse42, findIntAvx2 };
+      bool usable[2] = { hasSse42(), hasAvx2() };
+      for( int v = 0; v < 2; v ++ )
+      {
+         if( !usable[v] )
+         {
+            cout << setw(12) << "n/a" << setw(10) << "-";
+            continue;
+         }
+         long sum = 0;
+         double ns = time_kernel(versions[v], data, n, keys, NUM_KEYS,
+                                 reps, sum);
+         if( sum != scalarSum )
+         {
+            cout << endl << "MISMATCH between kernels at n = " << n << endl;
+            return EXIT_FAILURE;
+         }
+         cout << setw(12) << ns << setw(9) << scalarNs / ns << "x";
+      }
+      cout << endl;
+
+      delete [] data;
+      delete [] keys;
+   }
+
+   return EXIT_SUCCESS;
+}
+
+double time_kernel(FindFn fn, const int* data, int n,
+                   const int* keys, int numKeys, int reps, long& checksum)
+{
+   clock_t start = clock();
+   for( int r = 0; r < reps; r ++ )
+   {
+      for( int k = 0; k < numKeys; k ++ )
+         checksum += fn(data, n, keys[k]);
+   }
+   double seconds = static_cast<double>( clock() - start ) / CLOCKS_PER_SEC;
+
+   return seconds * 1e9 / ( static_cast<double>(reps) * numKeys );
+}
@@ -0,0 +1,145 @@
+// FILE: ParallelBench.cpp
+//       A benchmark of the parallel set operations (unionWith,
+//       intersect and subtract with an IntSetThreadPool) on two large
+//       IntSet's, from 1 thread up to the # of hardware threads,
+//       compared with the serial versions.
+//
+// DESCRIPTION:
+// Both IntSet's get about set_size random values (DEFAULT_SET_SIZE if
+// not given) out of 2 * set_size, so about half of each one's values
+// are in the other. The serial operations are timed first; then, for
+// 1, 2, 4, ... threads, the parallel ones, each result being checked to
+// hold the same values in the same order as the serial one. Each run
+// works on fresh copies of the two IntSet's (made outside the timing),
+// as a batch job would on sets it has just built: the serial versions
+// would otherwise reuse the sorted views (see IntSet.cpp) cached by the
+// previous run. The best of REPEATS times (in milliseconds) and the
+// speedup of the three operations together over the serial versions
+// are printed to cout.
+// Usage: pbench [set_size] [max_threads]
+
+#include "IntSetParallel.h"
+#include "IntSet.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+using namespace std;
+
+const int DEFAULT_SET_SIZE = 10000000;
+const int REPEATS = 3;
+
+enum Op { UNION, INTERSECT, SUBTRACT };
+
+double timeOp(const IntSet& a, const IntSet& b, Op op,
+              IntSetThreadPool* pool, IntSet& result);
+// Pre:  (none)
+// Post: op has been run REPEATS times on a and b (by the serial version
+//       if pool is 0, otherwise with pool), the last result has been
+//       stored in result, and the best time in milliseconds returned.
+
+bool sameOrder(const IntSet& is1, const IntSet& is2);
+// Post: True is returned if is1 and is2 hold the same values in the
+//       same order, otherwise false is returned.
+
+int main(int argc, char* argv[])
+{
+   int setSize = ( argc > 1 ) ? atoi(argv[1]) : DEFAULT_SET_SIZE;
+   int maxThreads = ( argc > 2 ) ? atoi(argv[2])
+                                 : static_cast<int>(thread::hardware_concurrency());
+   if( setSize < 1 )
+      setSize = 1;
+   if( maxThreads < 1 )
+      maxThreads = 1;
+
+   srand(4417);
+   vector<int> values(setSize);
+   IntSet a;
+   IntSet b;
+   for( int i = 0; i < setSize; i ++ )
+      values[i] = rand() % ( 2 * setSize );
+   a.addAll(values.begin(), values.end());
+   for( int i = 0; i < setSize; i ++ )
+      values[i] = rand() % ( 2 * setSize );
+   b.addAll(values.begin(), values.end());
+
+   const char* names[] = { "union", "intersect", "subtract" };
+   IntSet serial[3];
+   double serialMs[3];
+   double serialTotal = 0;
+   for( int op = 0; op < 3; op ++ )
+   {
+      serialMs[op] = timeOp(a, b, static_cast<Op>(op), 0, serial[op]);
+      serialTotal += serialMs[op];
+   }
+
+   cout << "set sizes " << a.size() << " and " << b.size() << ", "
+        << thread::hardware_concurrency() << " hardware threads" << endl;
+   cout << setw(8) << "threads";
+   for( int op = 0; op < 3; op ++ )
+      cout << setw(14) << names[op];
+   cout << setw(10) << "speedup" << endl;
+
+   cout << setw(8) << "serial" << fixed << setprecision(1);
+   for( int op = 0; op < 3; op ++ )
+      cout << setw(14) << serialMs[op];
+   cout << setw(10) << "1.00x" << endl;
+
+   for( int t = 1; t <= maxThreads; t *= 2 )
+   {
+      IntSetThreadPool pool(t);
+      double total = 0;
+      cout << setw(8) << t;
+      for( int op = 0; op < 3; op ++ )
+      {
+         IntSet result;
+         double ms = timeOp(a, b, static_cast<Op>(op), &pool, result);
+         total += ms;
+         cout << setw(14) << ms;
+         if( !sameOrder(result, serial[op]) )
+         {
+            cout << endl << names[op] << " with " << t
+                 << " threads differs from the serial result" << endl;
+            return EXIT_FAILURE;
+         }
+      }
+      cout << setw(9) << setprecision(2) << serialTotal / total << "x"
+           << setprecision(1) << endl;
+   }
+
+   return EXIT_SUCCESS;
+}
+
+double timeOp(const IntSet& a, const IntSet& b, Op op,
+              IntSetThreadPool* pool, IntSet& result)
+{
+   double best = 0;
+   for( int r = 0; r < REPEATS; r ++ )
+   {
+      IntSet fresh1(a);                // (copies have no sorted view)
+      IntSet fresh2(b);
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      if( pool == 0 )
+         result = ( op == UNION ) ? fresh1.unionWith(fresh2)
+                : ( op == INTERSECT ) ? fresh1.intersect(fresh2)
+                                      : fresh1.subtract(fresh2);
+      else
+         result = ( op == UNION ) ? fresh1.unionWith(fresh2, *pool)
+                : ( op == INTERSECT ) ? fresh1.intersect(fresh2, *pool)
+                                      : fresh1.subtract(fresh2, *pool);
+      double ms = chrono::duration<double, milli>(chrono::steady_clock::now()
+                                                  - start).count();
+      if( r == 0 || ms < best )
+         best = ms;
+   }
+   return best;
+}
+
+bool sameOrder(const IntSet& is1, const IntSet& is2)
+{
+   return ( is1.size() == is2.size()
+            && equal(is1.begin(), is1.end(), is2.begin()) );
+}
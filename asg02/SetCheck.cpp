@@ -0,0 +1,511 @@
+// FILE: SetCheck.cpp
+//       A non-interactive check of the asg02 set classes other than
+//       IntSet (which a2testSCB.in/.out check): 'make check' runs it and
+//       compares its output with the expected output in setcheck.out.
+//
+// DESCRIPTION:
+// Each set class with the IntSet operations is run through the same
+// script of set algebra (see checkAlgebra), on:
+//   small - a few values, with duplicates and values not in the set
+//           (more than fit in SmallIntSet<4>'s inline storage)
+//   wide  - values at the ends of the int range and on both sides of
+//           the 2^16 boundaries (BitmapIntSet's chunks)
+//   dense - thousands of values, in long runs with holes, growing past
+//           and shrinking below 4096 values per chunk (BitmapIntSet's
+//           ARRAY/BITMAP switch, and RunRep's switch from runs to
+//           keys), then edited after optimize (which turns
+//           BitmapIntSet's run-like chunks into RUN containers)
+// ConcurrentIntSet is checked on its own (see checkConcurrent): its
+// changes one at a time, then snapshots taken by reader threads while a
+// writer thread changes the set. The IntSet file format is checked by
+// round trips (see checkFile) through the file TEMP_FILE, which is
+// removed afterwards. IntSet's copies of, and results from, a
+// moved-from IntSet are checked too (see checkMoved).
+// Every result is written to cout as one line: a set of up to SHOW_MAX
+// values in full (as DumpData displays it), a bigger one as its size,
+// the sum of its values and a hash of its DumpData text, so the order
+// the values are displayed in is checked too.
+// Usage: setcheck [SECTION ...]   (the sections named, or all of them:
+//                                  bitmap, small, basic, sorted64,
+//                                  runs, concurrent, file, moved)
+
+#include "BitmapIntSet.h"
+#include "SmallIntSet.h"
+#include "BasicIntSet.h"
+#include "ConcurrentIntSet.h"
+#include "IntSetFile.h"
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+using namespace std;
+
+const int SHOW_MAX = 12;
+const int READERS = 4;
+const int PAIRS = 2000;
+const char TEMP_FILE[] = "setcheck.tmp";
+
+template <class Set>
+void show(const string& label, const Set& s, ostream& out);
+// Pre:  (none)
+// Post: label and s (in full, or summarized; see above) have been
+//       written to out as one line.
+
+template <class Set>
+int addRange(Set& s, int lo, int hi, int step);
+template <class Set>
+int removeRange(Set& s, int lo, int hi, int step);
+// Pre:  step >= 1
+// Post: lo, lo + step, ... (up to hi, inclusive) have been added to /
+//       removed from s, and the # of calls that returned true is
+//       returned.
+
+template <class Set>
+void optimize(Set& s);
+void optimize(BitmapIntSet& s);
+// Post: s has been switched to its most compact form, if it has one
+//       (BitmapIntSet::runOptimize), and is otherwise unchanged.
+
+template <class Set>
+void checkAlgebra(const string& name, ostream& out);
+// Pre:  (none)
+// Post: The script has been run on sets of type Set, and its results
+//       written to out, each line starting with name.
+
+void checkConcurrent(ostream& out);
+// Pre:  (none)
+// Post: ConcurrentIntSet has been checked (see below), and the results
+//       written to out.
+
+void checkFile(ostream& out);
+// Pre:  TEMP_FILE may be written in the current directory.
+// Post: The IntSet file functions have been checked (see below), the
+//       results written to out, and TEMP_FILE removed.
+
+void checkMoved(ostream& out);
+// Pre:  (none)
+// Post: IntSet's copy constructor, assignment and set algebra have been
+//       checked on a moved-from IntSet (see below), and the results
+//       written to out.
+
+bool wanted(const char* section, int argc, char* argv[]);
+// Post: True is returned if section is named in argv[1..argc - 1], or
+//       if no section is named.
+
+int main(int argc, char* argv[])
+{
+   if( wanted("bitmap", argc, argv) )
+      checkAlgebra<BitmapIntSet>("bitmap", cout);
+   if( wanted("small", argc, argv) )
+      checkAlgebra< SmallIntSet<4> >("small", cout);
+   if( wanted("basic", argc, argv) )
+      checkAlgebra< BasicIntSet<int> >("basic", cout);
+   if( wanted("sorted64", argc, argv) )
+      checkAlgebra< BasicIntSet<long long, SortedRep<long long> > >("sorted64", cout);
+   if( wanted("runs", argc, argv) )
+      checkAlgebra< BasicIntSet<int, RunRep<int> > >("runs", cout);
+   if( wanted("concurrent", argc, argv) )
+      checkConcurrent(cout);
+   if( wanted("file", argc, argv) )
+      checkFile(cout);
+   if( wanted("moved", argc, argv) )
+      checkMoved(cout);
+   return EXIT_SUCCESS;
+}
+
+// ==========================================================================
+
+template <class Set>
+void show(const string& label, const Set& s, ostream& out)
+{
+   ostringstream text;
+   s.DumpData(text);
+   out << label << ": ";
+   if( s.size() <= SHOW_MAX )
+   {
+      out << "{" << text.str() << "}" << endl;
+      return;
+   }
+
+   istringstream values(text.str());
+   long long sum = 0;
+   long long v;
+   while( values >> v )
+      sum += v;
+
+   unsigned long long hash = 14695981039346656037ULL;   // FNV-1a
+   const string& str = text.str();
+   for( size_t i = 0; i < str.size(); i ++ )
+      hash = ( hash ^ static_cast<unsigned char>(str[i]) ) * 1099511628211ULL;
+
+   out << "size " << s.size() << ", sum " << sum << ", hash " << hex
+       << hash << dec << endl;
+}
+
+// ==========================================================================
+
+template <class Set>
+int addRange(Set& s, int lo, int hi, int step)
+{
+   int added = 0;
+   for( long long v = lo; v <= hi; v += step )
+      added += s.add(static_cast<int>(v));
+   return added;
+}
+
+// ==========================================================================
+
+template <class Set>
+int removeRange(Set& s, int lo, int hi, int step)
+{
+   int removed = 0;
+   for( long long v = lo; v <= hi; v += step )
+      removed += s.remove(static_cast<int>(v));
+   return removed;
+}
+
+// ==========================================================================
+
+template <class Set>
+void optimize(Set&)
+{
+}
+
+// ==========================================================================
+
+void optimize(BitmapIntSet& s)
+{
+   s.runOptimize();
+}
+
+// ==========================================================================
+
+template <class Set>
+void checkAlgebra(const string& name, ostream& out)
+
+// this function runs the script on each pair of sets, showing both sets
+// and the results of the set operations (both ways round for subtract)
+// and of the comparisons
+{
+   Set a;
+   Set b;
+   Set empty;
+   string n = name + " ";
+   int r;
+
+   // small
+   const int smallA[] = { 5, 3, 9, 1, 3, -4 };
+   const int smallB[] = { 9, 2, 3, 7, -4, 11 };
+   r = 0;
+   for( int i = 0; i < 6; i ++ )
+   {
+      r += a.add(smallA[i]);
+      r += b.add(smallB[i]);
+   }
+   out << n << "small adds: " << r << ", removes: " << a.remove(7);
+   out << b.remove(11);
+   out << b.remove(11) << endl;
+   show(n + "small A", a, out);
+   show(n + "small B", b, out);
+   show(n + "small A | B", a.unionWith(b), out);
+   show(n + "small A & B", a.intersect(b), out);
+   show(n + "small A - B", a.subtract(b), out);
+   show(n + "small B - A", b.subtract(a), out);
+   show(n + "small A & {}", a.intersect(empty), out);
+   show(n + "small {} - A", empty.subtract(a), out);
+   out << n << "small subset: " << a.isSubsetOf(a.unionWith(b))
+       << a.isSubsetOf(b) << a.intersect(b).isSubsetOf(b)
+       << empty.isSubsetOf(a) << ", equal: " << ( a == b )
+       << ( a == Set(a) ) << ( a.unionWith(b) == b.unionWith(a) )
+       << ", contains: " << a.contains(9) << a.contains(2)
+       << ", empty: " << a.isEmpty() << empty.isEmpty() << endl;
+
+   // wide
+   a.reset();
+   b.reset();
+   const int wideA[] = { INT_MIN, INT_MIN + 1, -65537, -65536, -1, 0,
+                         65535, 65536, INT_MAX - 1, INT_MAX };
+   const int wideB[] = { INT_MAX, 65536, 65537, 0, -65536, -65535,
+                         INT_MIN, 1000000 };
+   for( int i = 0; i < 10; i ++ )
+      a.add(wideA[i]);
+   for( int i = 0; i < 8; i ++ )
+      b.add(wideB[i]);
+   show(n + "wide A", a, out);
+   show(n + "wide B", b, out);
+   show(n + "wide A | B", a.unionWith(b), out);
+   show(n + "wide A & B", a.intersect(b), out);
+   show(n + "wide A - B", a.subtract(b), out);
+   show(n + "wide B - A", b.subtract(a), out);
+   out << n << "wide removes: " << a.remove(INT_MIN);
+   out << a.remove(INT_MAX);
+   out << a.remove(65536);
+   out << a.remove(65536) << endl;
+   show(n + "wide A", a, out);
+
+   // dense
+   a.reset();
+   b.reset();
+   r = addRange(a, 0, 9999, 1);
+   r -= removeRange(a, 0, 9999, 7);
+   r += addRange(a, 3 * 65536, 3 * 65536 + 2999, 1);
+   out << n << "dense A built: " << r << endl;
+   r = addRange(b, 5001, 79999, 2);
+   r += addRange(b, -70000, -60000, 3);
+   out << n << "dense B built: " << r << endl;
+   show(n + "dense A", a, out);
+   show(n + "dense B", b, out);
+   show(n + "dense A | B", a.unionWith(b), out);
+   show(n + "dense A & B", a.intersect(b), out);
+   show(n + "dense A - B", a.subtract(b), out);
+   show(n + "dense B - A", b.subtract(a), out);
+
+   r = removeRange(a, 0, 9999, 2);
+   r += removeRange(a, 1, 1999, 4);                  // below 4096 again
+   out << n << "dense A thinned: " << r << endl;
+   show(n + "dense A", a, out);
+   show(n + "dense A & B", a.intersect(b), out);
+
+   optimize(a);
+   optimize(b);
+   show(n + "optimized A", a, out);
+   show(n + "optimized B", b, out);
+   const int edits[] = { -( 3 * 65536 ), -( 3 * 65536 + 1500 ),
+                         -( 3 * 65536 + 2999 ), 3 * 65536 + 3000,
+                         3 * 65536 + 1500, 3 * 65536 - 1 };
+   r = 0;
+   for( int i = 0; i < 6; i ++ )                     // (-v: remove v)
+      r += ( edits[i] < 0 ) ? a.remove(-edits[i]) : a.add(edits[i]);
+   r += b.remove(5001);
+   r += b.add(5000);
+   r += b.add(5002);
+   r += b.remove(5004);
+   out << n << "optimized edits: " << r << endl;
+   r = removeRange(a, 3 * 65536 + 100, 3 * 65536 + 2899, 2);
+   out << n << "optimized A split: " << r << endl;
+   show(n + "optimized A", a, out);
+   show(n + "optimized B", b, out);
+   show(n + "optimized A | B", a.unionWith(b), out);
+   show(n + "optimized A & B", a.intersect(b), out);
+   show(n + "optimized A - B", a.subtract(b), out);
+   show(n + "optimized B - A", b.subtract(a), out);
+   out << n << "optimized subset: " << a.isSubsetOf(a.unionWith(b))
+       << a.subtract(b).isSubsetOf(a) << b.isSubsetOf(a) << ", equal: "
+       << ( a.unionWith(b) == b.unionWith(a) ) << ( a == b ) << endl;
+}
+
+// ==========================================================================
+
+void checkConcurrent(ostream& out)
+
+// this function makes each kind of change from one thread, showing a
+// snapshot after each, and more while holding a snapshot (which must
+// neither block the changes nor see them), then has a writer add PAIRS pairs of values (2k, 2k + 1), one pair per modify,
+// while READERS threads keep taking snapshots: a snapshot that doesn't
+// hold pairs 0 .. k - 1 exactly, for some k, saw a change half made
+{
+   ConcurrentIntSet cs;
+   out << "concurrent adds: " << cs.add(5);
+   out << cs.add(3);
+   out << cs.add(5) << endl;
+   const int more[] = { 7, 3, 11, -2 };
+   out << "concurrent addAll: " << cs.addAll(more, more + 4) << endl;
+   show("concurrent set", cs.snapshot(), out);
+   out << "concurrent removes: " << cs.remove(3);
+   out << cs.remove(3) << endl;
+   cs.modify([](IntSet& set) { set.remove(5); set.add(1); set.add(2); });
+   show("concurrent modified", cs.snapshot(), out);
+   out << "concurrent contains: " << cs.contains(1) << cs.contains(5)
+       << ", size: " << cs.size() << endl;
+   show("concurrent copy", cs.snapshot().toIntSet().unionWith(IntSet()), out);
+   cs.reset();
+   show("concurrent reset", cs.snapshot(), out);
+   cs.add(4);
+   {
+      ConcurrentIntSet::Snapshot held = cs.snapshot();
+      cs.add(8);
+      cs.remove(4);
+      cs.modify([](IntSet& set) { set.add(6); set.add(9); });
+      show("concurrent held", held, out);
+      show("concurrent changed while held", cs.snapshot(), out);
+   }
+   cs.add(10);                         // (releases the held snapshot)
+   show("concurrent after held", cs.snapshot(), out);
+
+   ConcurrentIntSet shared;
+   atomic<bool> done(false);
+   atomic<long> torn(0);
+   vector<thread> readers;
+   for( int r = 0; r < READERS; r ++ )
+   {
+      readers.push_back(thread([&shared, &done, &torn]()
+      {
+         while( !done.load() )
+         {
+            ConcurrentIntSet::Snapshot snap = shared.snapshot();
+            int k = snap.size() / 2;
+            if( snap.size() % 2 != 0
+                || ( k > 0 && !( snap.contains(0) && snap.contains(2 * k - 1) ) )
+                || snap.contains(2 * k) )
+               torn ++;
+         }
+      }));
+   }
+   for( int k = 0; k < PAIRS; k ++ )
+      shared.modify([k](IntSet& set) { set.add(2 * k); set.add(2 * k + 1); });
+   done.store(true);
+   for( int r = 0; r < READERS; r ++ )
+      readers[r].join();
+
+   show("concurrent pairs", shared.snapshot(), out);
+   out << "concurrent half-made changes seen: " << torn.load() << endl;
+}
+
+// ==========================================================================
+
+void checkFile(ostream& out)
+
+// this function saves each of a few IntSet's (with and without their
+// membership order), loads it back, and maps it, checking that what
+// comes back has the same values (and, with the order kept, the same
+// DumpData), and that MappedIntSet finds every value and no other;
+// then it checks that a missing, cut-short or garbled file is rejected
+// and leaves the IntSet it was to be loaded into unchanged
+{
+   IntSet sets[4];                     // empty, small, wide, dense
+   const int small[] = { 42, -7, 1000, 3, 0, 999 };
+   sets[1].addAll(small, small + 6);
+   const int wide[] = { INT_MAX, INT_MIN, -1, 65536, INT_MIN + 1,
+                        INT_MAX - 1, 0 };
+   sets[2].addAll(wide, wide + 7);
+   for( int v = 100000; v > -100000; v -= 3 )    // (descending)
+      sets[3].add(v);
+   removeRange(sets[3], -29999, 30000, 6);       // (every other one)
+   const char* names[] = { "empty", "small", "wide", "dense" };
+
+   for( int i = 0; i < 4; i ++ )
+   {
+      for( int keep = 1; keep >= 0; keep -- )
+      {
+         string n = string("file ") + names[i] + ( keep ? " ordered" : " sorted" );
+         IntSet loaded;
+         bool saved = saveIntSet(sets[i], TEMP_FILE, keep == 1);
+         bool read = loadIntSet(TEMP_FILE, loaded);
+         ostringstream text;
+         ostringstream loadedText;
+         sets[i].DumpData(text);
+         loaded.DumpData(loadedText);
+         out << n << ": saved " << saved << ", loaded " << read
+             << ", equal " << ( loaded == sets[i] ) << ", same order "
+             << ( loadedText.str() == text.str() ) << endl;
+         show(n + " loaded", loaded, out);
+
+         MappedIntSet mapped;
+         IntSet fromMap;
+         bool opened = mapped.open(TEMP_FILE);
+         bool converted = mapped.toIntSet(fromMap);
+         int found = 0;
+         int misses = 0;
+         istringstream values(text.str());
+         int v;
+         while( values >> v )
+         {
+            found += mapped.contains(v);
+            misses += ( v < INT_MAX && !sets[i].contains(v + 1)
+                        && mapped.contains(v + 1) );
+         }
+         out << n << " mapped: opened " << opened << ", size "
+             << mapped.size() << ", order " << mapped.hasOrder()
+             << ", found " << found << ", false hits " << misses
+             << ", misses 5/-4/2^31-3: " << mapped.contains(5)
+             << mapped.contains(-4) << mapped.contains(INT_MAX - 2)
+             << ", converted " << converted << ", same as loaded "
+             << ( fromMap == loaded ) << endl;
+      }
+   }
+
+   IntSet kept(sets[1]);
+   out << "file missing: " << loadIntSet("setcheck.none", kept);
+   MappedIntSet mapped;
+   out << mapped.open("setcheck.none") << mapped.isOpen() << endl;
+
+   saveIntSet(sets[3], TEMP_FILE);
+   ifstream in(TEMP_FILE, ios::binary);
+   string bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+   in.close();
+   ofstream cut(TEMP_FILE, ios::binary | ios::trunc);
+   cut.write(bytes.data(), bytes.size() / 2);
+   cut.close();
+   out << "file cut short: " << loadIntSet(TEMP_FILE, kept)
+       << mapped.open(TEMP_FILE) << endl;
+
+   bytes[0] ^= 0x20;                  // (the magic number)
+   ofstream bad(TEMP_FILE, ios::binary | ios::trunc);
+   bad.write(bytes.data(), bytes.size());
+   bad.close();
+   out << "file garbled: " << loadIntSet(TEMP_FILE, kept)
+       << mapped.open(TEMP_FILE) << endl;
+   show("file unchanged", kept, out);
+   remove(TEMP_FILE);
+}
+
+// ==========================================================================
+
+void checkMoved(ostream& out)
+
+// this function moves an IntSet away (leaving it empty, with no array),
+// then copies it, assigns to and from it, and uses it in set algebra,
+// writing each result; run under a leak checker, it also checks that
+// none of these loses an array
+{
+   IntSet a;
+   a.add(1);
+   IntSet b(std::move(a));
+   show("moved from", a, out);
+   show("moved to", b, out);
+
+   IntSet c(a);                        // copy of a moved-from set
+   show("moved copy", c, out);
+   c = b;
+   show("moved copy = to", c, out);
+
+   IntSet d = a.intersect(b);
+   show("moved intersect to", d, out);
+   d = b;
+   show("moved intersect = to", d, out);
+   IntSet e = a.subtract(b);
+   show("moved subtract to", e, out);
+   e = b.unionWith(a);
+   show("moved to union", e, out);
+
+   a = c;                              // assigned to after the move
+   a.add(2);
+   show("moved from = copy, add", a, out);
+   IntSet f(std::move(c));
+   f.add(3);                           // and added to after the move
+   c.add(4);
+   show("moved again", f, out);
+   show("moved again from, add", c, out);
+}
+
+// ==========================================================================
+
+bool wanted(const char* section, int argc, char* argv[])
+{
+   if( argc == 1 )
+      return true;
+   for( int i = 1; i < argc; i ++ )
+   {
+      if( strcmp(argv[i], section) == 0 )
+         return true;
+   }
+   return false;
+}
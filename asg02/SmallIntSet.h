@@ -0,0 +1,131 @@
+// FILE: SmallIntSet.h - header file for SmallIntSet template class
+// TEMPLATE CLASS PROVIDED:
+//                 template <int N>
+//                 class SmallIntSet
+//                 (a container class for a set of int values that
+//                 keeps up to N of them inside the object itself)
+//
+// SmallIntSet<N> combines the two IntSet's of asg01 and asg02: like the
+// static-array IntSet (asg01) it holds its first N values in an array
+// that is part of the object, so a set that never grows past N values
+// never allocates dynamic memory; but like the dynamic-array IntSet
+// (asg02) it has no upper limit: the first add() past N values moves
+// the values to a dynamic array (and from then on it grows by 1.5x).
+// The values are kept in membership order exactly as IntSet does.
+//
+// SmallIntSet is meant for sets that are mostly small: lookups scan the
+// values (with the SIMD kernel of IntSetKernels.h) while they are few.
+// A set that has spilled and grown to 16 or more values also keeps a
+// hash index (as IntSet does), so add and contains stay O(1) expected
+// however large it grows; remove is O(n), since the values after the
+// one removed move down to keep membership order.
+//
+// TEMPLATE PARAMETER and MEMBER CONSTANT
+//   int N
+//     The # of values held without dynamic memory (N >= 1).
+//   static const int INLINE_CAPACITY = N
+//
+// CONSTRUCTOR
+//   SmallIntSet()
+//     Pre:  (none)
+//     Post: The invoking SmallIntSet is initialized to an empty set,
+//           using its built-in array.
+//
+// CONSTANT MEMBER FUNCTIONS (ACCESSORS)
+//   int size() const
+//   bool isEmpty() const
+//   bool contains(int anInt) const
+//   bool isSubsetOf(const SmallIntSet& otherSet) const
+//   void DumpData(std::ostream& out) const
+//   SmallIntSet unionWith(const SmallIntSet& otherSet) const
+//   SmallIntSet intersect(const SmallIntSet& otherSet) const
+//   SmallIntSet subtract(const SmallIntSet& otherSet) const
+//     Pre/Post: Exactly as for the IntSet functions of the same name
+//           (see IntSet.h), including the membership order of the
+//           values displayed by DumpData and of the values in the
+//           SmallIntSet's returned by the set operations.
+//   bool isInline() const
+//     Pre:  (none)
+//     Post: True is returned if the values are held in the built-in
+//           array (no dynamic memory is in use), otherwise false.
+//
+// MODIFICATION MEMBER FUNCTIONS (MUTATORS)
+//   void reset()
+//     Pre:  (none)
+//     Post: The invoking SmallIntSet is reset to become an empty set,
+//           and any dynamic memory it was using has been released.
+//   bool add(int anInt)
+//   bool remove(int anInt)
+//     Pre/Post: Exactly as for the IntSet functions of the same name.
+//
+// NON-MEMBER FUNCTIONS
+//   template <int N>
+//   bool operator==(const SmallIntSet<N>& ss1, const SmallIntSet<N>& ss2)
+//     Pre:  (none)
+//     Post: True is returned if ss1 and ss2 have the same elements,
+//           otherwise false is returned.
+//
+// VALUE SEMANTICS
+//   Assignment and the copy constructor may be used with SmallIntSet
+//   objects; so may move construction and move assignment, which take
+//   over the dynamic array of the source (if it has one) and leave the
+//   source empty.
+
+#ifndef SMALL_INT_SET_H
+#define SMALL_INT_SET_H
+
+#include <iostream>
+
+template <int N>
+class SmallIntSet
+{
+public:
+   static const int INLINE_CAPACITY = N;
+   SmallIntSet();
+   SmallIntSet(const SmallIntSet& src);
+   SmallIntSet(SmallIntSet&& src) noexcept;
+   ~SmallIntSet();
+   SmallIntSet& operator=(const SmallIntSet& rhs);
+   SmallIntSet& operator=(SmallIntSet&& rhs) noexcept;
+   int size() const;
+   bool isEmpty() const;
+   bool contains(int anInt) const;
+   bool isSubsetOf(const SmallIntSet& otherSet) const;
+   void DumpData(std::ostream& out) const;
+   SmallIntSet unionWith(const SmallIntSet& otherSet) const;
+   SmallIntSet intersect(const SmallIntSet& otherSet) const;
+   SmallIntSet subtract(const SmallIntSet& otherSet) const;
+   bool isInline() const;
+   void reset();
+   bool add(int anInt);
+   bool remove(int anInt);
+
+private:
+   static_assert(N >= 1, "SmallIntSet needs room for at least 1 value");
+   static const int INDEX_THRESHOLD = 16;
+   int  inlineData[N];
+   int* data;
+   int  capacity;
+   int  used;
+   int* index;
+   int  indexSize;
+   static int homeSlot(int anInt, int mask);
+   static int indexSizeFor(int numVals);
+   int  findSlot(int anInt) const;
+   int  find(int anInt) const;
+   void buildIndex(int new_size);
+   void syncIndex();
+   void indexInsert(int pos);
+   void indexErase(int slot);
+   void grow(int new_capacity);
+   void copyFrom(const SmallIntSet& src);
+   void stealFrom(SmallIntSet& src);
+   int  matchWith(const SmallIntSet& otherSet,
+                  char* thisHit, char* otherHit) const;
+};
+
+template <int N>
+bool operator==(const SmallIntSet<N>& ss1, const SmallIntSet<N>& ss2);
+
+#include "SmallIntSet.template"   // include the implementation
+#endif
@@ -11,9 +11,16 @@
 #include <iostream>    // provides cout.
 #include <cstring>     // provides memcpy.
 #include <cstdlib>     // provides size_t.
+#ifdef CHUNK_SEQUENCE
+#include "ChunkSequence.h"  // a3c: the same tests of chunk_sequence.
+#else
 #include "Sequence.h"  // provides the sequence class with double items.
+#endif
 using namespace std;
 using namespace CS3358_SSII_2015;
+#ifdef CHUNK_SEQUENCE
+typedef chunk_sequence sequence;
+#endif
 
 // Descriptions and points for each of the tests:
 const size_t MANY_TESTS = 7;
@@ -0,0 +1,650 @@
+// FILE: ChunkSequence.cpp
+// CLASS IMPLEMENTED: chunk_sequence (see ChunkSequence.h for documentation)
+// INVARIANT for the chunk_sequence ADT:
+//   1. The number of items in the sequence is in the member variable
+//      used.
+//   2. The items are stored, in order, in the leaves of a B+ tree whose
+//      root is pointed to by the member variable root (0 for an empty
+//      sequence). A leaf holds count items (1 to LEAF_SIZE) in
+//      items[0] through items[count-1]; an inner node has count
+//      children (2 to FANOUT) in kids[0] through kids[count-1]. Every
+//      leaf is at the same depth, and every node but the root and the
+//      last node of each level has at least half as many entries as it
+//      may hold (LEAF_SIZE / 2 items or FANOUT / 2 children); the last
+//      nodes may have fewer, since appending fills nodes completely
+//      instead of splitting them in half. Each node's total is the
+//      number of items in its subtree, and parent points to the inner
+//      node it is a child of (0 for the root).
+//   3. The leaves are also linked in order, through prev and next,
+//      from the member variable head (the first leaf) to tail (the
+//      last); both are 0 for an empty sequence.
+//   4. The index of the current item is in the member variable
+//      current_index, which is equal to used if there is no current
+//      item (as for sequence; see Sequence.cpp). If there is a current
+//      item, it is cur_leaf->items[cur_offset]; otherwise cur_leaf is
+//      0.
+//
+// DOCUMENTATION for private member (helper) functions:
+//   void clear()
+//    Pre:  none
+//    Post: Every node has been freed, and the sequence is empty.
+//   void copy_from(const chunk_sequence& source)
+//    Pre:  The sequence is empty.
+//    Post: The sequence holds the items of source, with the same
+//      current item.
+//   void locate(size_type index, leaf*& where, size_type& offset) const
+//    Pre:  index < used
+//    Post: The item at position index is where->items[offset] (found by
+//      going down the tree by the children's totals).
+//   void relocate()
+//    Pre:  current_index <= used
+//    Post: cur_leaf and cur_offset have been set from current_index (as
+//      in invariant 4).
+//   void insert_at(size_type index, const value_type& entry)
+//    Pre:  index <= used
+//    Post: A copy of entry is the item at position index, and the items
+//      from there on have moved up one position (cur_leaf and
+//      cur_offset may be out of date).
+//   void remove_at(size_type index)
+//    Pre:  index < used
+//    Post: The item at position index has been removed, and the items
+//      after it have moved down one position (cur_leaf and cur_offset
+//      may be out of date).
+//   void split(node* n, bool at_end)
+//    Pre:  n is full (a leaf of LEAF_SIZE items) or overfull (an inner
+//      node of FANOUT + 1 children); the rest of the tree is valid. If
+//      at_end is true, n is the last node of its level.
+//    Post: The upper half of n (if at_end is false), or else as little
+//      of it as leaves both nodes valid (nothing of a leaf, the last 2
+//      children of an inner node), has been moved to a new node just
+//      after it, and the tree is valid (its parent, and so on up, may
+//      have been split in turn, the same way, and a new root made).
+//   void rebalance(node* n)
+//    Pre:  n may have too few entries; the rest of the tree is valid.
+//    Post: n has taken entries from a sibling, or has been merged with
+//      it (and the parent rebalanced in turn), or, as the root, been
+//      freed if it was an empty leaf or an inner node with one child;
+//      the tree is valid.
+//   static void free_node(node* n)
+//   static void free_tree(node* n)
+//    Pre:  n is not 0.
+//    Post: n, or n and all the nodes under it, have been freed.
+//   static void add_to_totals(node* n, long delta)
+//    Pre:  n is not 0.
+//    Post: delta has been added to the total of n and of each node
+//      above it.
+//   static size_type child_index(const inner* parent, const node* child)
+//    Pre:  child is one of parent's children.
+//    Post: Its position among them is returned.
+//   static void insert_child(inner* parent, size_type pos, node* child)
+//    Pre:  parent has fewer than FANOUT + 1 children; pos <= its count.
+//    Post: child is parent's child at pos (the later ones moved up),
+//      and its parent is parent; the totals are unchanged.
+//   static void move_entries(node* from, size_type at, size_type count,
+//                            node* to, size_type to_at)
+//    Pre:  from and to are both leaves or both inner nodes, other than
+//      each other; from has count entries from at on, and to has room
+//      for them.
+//    Post: Those entries have been moved to to, at to_at (to's entries
+//      from there on moved up, from's after them moved down); the
+//      counts and totals of from and to (but of no node above them)
+//      account for the move, and moved children point to to.
+
+#include <cassert>
+#include "ChunkSequence.h"
+using namespace std;
+
+namespace CS3358_SSII_2015
+{
+   struct chunk_sequence::node
+   {
+      inner* parent;
+      size_type count;                    // # of items or children
+      size_type total;                    // # of items in the subtree
+      bool is_leaf;
+   };
+
+   struct chunk_sequence::leaf : chunk_sequence::node
+   {
+      value_type items[LEAF_SIZE];
+      leaf* prev;
+      leaf* next;
+   };
+
+   struct chunk_sequence::inner : chunk_sequence::node
+   {
+      node* kids[FANOUT + 1];             // (one extra until it splits)
+   };
+
+   // =====================================================================
+
+   chunk_sequence::chunk_sequence(size_type)
+   :root(0), head(0), tail(0), used(0), current_index(0), cur_leaf(0),
+    cur_offset(0)
+
+   // this function is a parameterized constructor for the chunk_sequence
+   // class; no memory is taken until the first item is added
+   {
+   }
+
+   // =====================================================================
+
+   chunk_sequence::chunk_sequence(const chunk_sequence& source)
+   :root(0), head(0), tail(0), used(0), current_index(0), cur_leaf(0),
+    cur_offset(0)
+
+   // this function is a copy constructor for the chunk_sequence class
+   {
+      copy_from(source);
+   }
+
+   // =====================================================================
+
+   chunk_sequence::~chunk_sequence()
+
+   // this function is the destructor for the chunk_sequence class
+   {
+      clear();
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::resize(size_type)
+
+   // this function does nothing: chunks are taken as they are needed
+   {
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::start()
+   {
+      current_index = 0;
+      cur_leaf = head;
+      cur_offset = 0;
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::advance()
+
+   // this function steps to the next item in the same chunk, or to the
+   // first item of the next chunk (none after the last chunk, which
+   // leaves cur_leaf 0 just as current_index reaches used)
+   {
+      if( is_item() )
+      {
+         current_index++;
+         cur_offset++;
+         if( cur_offset == cur_leaf->count )
+         {
+            cur_leaf = cur_leaf->next;
+            cur_offset = 0;
+         }
+      }
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::insert(const value_type& entry)
+
+   // this function inserts entry before the current item (or at the
+   // front of the sequence if there is none); it becomes the current
+   // item
+   {
+      if( !is_item() )
+         current_index = 0;
+
+      insert_at(current_index, entry);
+      relocate();
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::attach(const value_type& entry)
+
+   // this function inserts entry after the current item (or at the end
+   // of the sequence if there is none); it becomes the current item
+   {
+      if( is_item() )
+         current_index++;
+      else
+         current_index = used;
+
+      insert_at(current_index, entry);
+      relocate();
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::remove_current()
+
+   // this function removes the current item; the item after it, now at
+   // the same index, becomes the current item (if there is one)
+   {
+      if( is_item() )
+      {
+         remove_at(current_index);
+         relocate();
+      }
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::seek(size_type index)
+   {
+      if( index > used )                  // (past the end: no current
+         index = used;                    //  item)
+
+      current_index = index;
+      relocate();
+   }
+
+   // =====================================================================
+
+   chunk_sequence& chunk_sequence::operator=(const chunk_sequence& source)
+
+   // this function overloads the assignment operator for the
+   // chunk_sequence class
+   {
+      if( this == &source )
+         return *this;
+
+      clear();
+      copy_from(source);
+      return *this;
+   }
+
+   // =====================================================================
+
+   chunk_sequence::size_type chunk_sequence::size() const
+   {
+      return used;
+   }
+
+   // =====================================================================
+
+   bool chunk_sequence::is_item() const
+   {
+      return ( current_index != used );
+   }
+
+   // =====================================================================
+
+   chunk_sequence::value_type chunk_sequence::current() const
+   {
+      assert( is_item() );
+
+      return cur_leaf->items[cur_offset];
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::clear()
+   {
+      if( root != 0 )
+         free_tree(root);
+
+      root = 0;
+      head = tail = 0;
+      used = 0;
+      current_index = 0;
+      cur_leaf = 0;
+      cur_offset = 0;
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::copy_from(const chunk_sequence& source)
+
+   // this function appends the items of source, chunk by chunk, to the
+   // (empty) sequence, so that every chunk but the last is full, then
+   // finds the current item
+   {
+      const leaf* l;
+      size_type i;
+      for( l = source.head; l != 0; l = l->next )
+      {
+         for( i = 0; i < l->count; i++ )
+            insert_at(used, l->items[i]);
+      }
+
+      current_index = source.current_index;
+      relocate();
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::locate(size_type index, leaf*& where,
+                               size_type& offset) const
+
+   // this function goes down from the root, skipping the children whose
+   // items all come before position index
+   {
+      const node* n = root;
+      while( !n->is_leaf )
+      {
+         const inner* in = static_cast<const inner*>(n);
+         size_type k = 0;
+         while( index >= in->kids[k]->total )
+         {
+            index -= in->kids[k]->total;
+            k++;
+         }
+         n = in->kids[k];
+      }
+
+      where = static_cast<leaf*>( const_cast<node*>(n) );
+      offset = index;
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::relocate()
+   {
+      if( current_index < used )
+         locate(current_index, cur_leaf, cur_offset);
+      else
+      {
+         cur_leaf = 0;
+         cur_offset = 0;
+      }
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::insert_at(size_type index, const value_type& entry)
+
+   // this function finds the chunk for the new item (the last chunk if it
+   // goes at the end), splits the chunk first if it is full (or, at the
+   // end, starts a new one), and shifts the items after the new one
+   // within the chunk
+   {
+      leaf* l;
+      size_type offset;
+      size_type i;
+
+      if( root == 0 )
+      {
+         l = new leaf;
+         l->parent = 0;
+         l->count = l->total = 0;
+         l->is_leaf = true;
+         l->prev = l->next = 0;
+         root = head = tail = l;
+      }
+
+      if( index == used )
+      {
+         l = tail;
+         offset = tail->count;
+      }
+      else
+         locate(index, l, offset);
+
+      if( l->count == LEAF_SIZE && index == used )
+      {
+         split(l, true);                  // (appending: start a new,
+         l = tail;                        //  empty chunk rather than
+         offset = 0;                      //  leave two half-full ones)
+      }
+      else if( l->count == LEAF_SIZE )
+      {
+         split(l, false);
+         if( offset > l->count )          // (the new item goes in the
+         {                                //  upper half)
+            offset -= l->count;
+            l = l->next;
+         }
+      }
+
+      for( i = l->count; i > offset; i-- )
+         l->items[i] = l->items[i-1];
+      l->items[offset] = entry;
+      l->count++;
+      add_to_totals(l, 1);
+      used++;
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::remove_at(size_type index)
+   {
+      leaf* l;
+      size_type offset;
+      size_type i;
+
+      locate(index, l, offset);
+      for( i = offset + 1; i < l->count; i++ )
+         l->items[i-1] = l->items[i];
+      l->count--;
+      add_to_totals(l, -1);
+      used--;
+
+      rebalance(l);
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::split(node* n, bool at_end)
+
+   // this function moves the upper half of n (at the end, just what must
+   // go) to a new sibling, which is added to n's parent (a new root if n
+   // was the root) after n; a parent that overflows is split the same
+   // way
+   {
+      node* sibling;
+      if( n->is_leaf )
+      {
+         leaf* l = static_cast<leaf*>(n);
+         leaf* s = new leaf;
+         s->prev = l;                     // link s in after l
+         s->next = l->next;
+         if( l->next != 0 )
+            l->next->prev = s;
+         else
+            tail = s;
+         l->next = s;
+         sibling = s;
+      }
+      else
+         sibling = new inner;
+      sibling->count = sibling->total = 0;
+      sibling->is_leaf = n->is_leaf;
+      sibling->parent = 0;
+
+      size_type keep = n->count / 2;
+      if( at_end )
+         keep = n->is_leaf ? n->count : n->count - 2;
+      move_entries(n, keep, n->count - keep, sibling, 0);
+
+      if( n->parent == 0 )
+      {
+         inner* r = new inner;
+         r->parent = 0;
+         r->is_leaf = false;
+         r->count = 0;
+         r->total = n->total + sibling->total;
+         insert_child(r, 0, n);
+         insert_child(r, 1, sibling);
+         root = r;
+      }
+      else
+      {
+         inner* p = n->parent;
+         insert_child(p, child_index(p, n) + 1, sibling);
+         if( p->count > FANOUT )
+            split(p, at_end);
+      }
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::rebalance(node* n)
+
+   // this function fixes a node that has fallen below half full: with a
+   // neighbouring sibling (the one before it, if any), it is merged if
+   // the two fit in one node, otherwise their entries are shared out
+   // evenly; a merge takes a child from the parent, which may then need
+   // fixing in turn
+   {
+      if( n == root )
+      {
+         if( n->is_leaf && n->count == 0 )
+         {
+            free_node(n);
+            root = 0;
+            head = tail = 0;
+         }
+         else if( !n->is_leaf && n->count == 1 )
+         {
+            root = static_cast<inner*>(n)->kids[0];
+            root->parent = 0;
+            free_node(n);
+         }
+         return;
+      }
+
+      size_type most = n->is_leaf ? LEAF_SIZE : FANOUT;
+      if( n->count >= most / 2 )
+         return;
+
+      inner* p = n->parent;
+      size_type k = child_index(p, n);
+      node* left = ( k > 0 ) ? p->kids[k-1] : n;
+      node* right = ( k > 0 ) ? n : p->kids[k+1];
+
+      if( left->count + right->count <= most )
+      {
+         move_entries(right, 0, right->count, left, left->count);
+         if( right->is_leaf )
+         {
+            leaf* l = static_cast<leaf*>(left);
+            leaf* r = static_cast<leaf*>(right);
+            l->next = r->next;
+            if( r->next != 0 )
+               r->next->prev = l;
+            else
+               tail = l;
+         }
+
+         size_type i;
+         for( i = child_index(p, right) + 1; i < p->count; i++ )
+            p->kids[i-1] = p->kids[i];
+         p->count--;
+         free_node(right);
+
+         rebalance(p);
+      }
+      else
+      {
+         size_type half = ( left->count + right->count ) / 2;
+         if( left->count < half )
+            move_entries(right, 0, half - left->count, left, left->count);
+         else
+            move_entries(left, half, left->count - half, right, 0);
+      }
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::free_node(node* n)
+   {
+      if( n->is_leaf )
+         delete static_cast<leaf*>(n);
+      else
+         delete static_cast<inner*>(n);
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::free_tree(node* n)
+   {
+      if( !n->is_leaf )
+      {
+         inner* in = static_cast<inner*>(n);
+         size_type k;
+         for( k = 0; k < in->count; k++ )
+            free_tree(in->kids[k]);
+      }
+      free_node(n);
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::add_to_totals(node* n, long delta)
+   {
+      for( ; n != 0; n = n->parent )
+         n->total += delta;
+   }
+
+   // =====================================================================
+
+   chunk_sequence::size_type chunk_sequence::child_index(const inner* parent,
+                                                         const node* child)
+   {
+      size_type k = 0;
+      while( parent->kids[k] != child )
+         k++;
+      return k;
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::insert_child(inner* parent, size_type pos,
+                                     node* child)
+   {
+      size_type i;
+      for( i = parent->count; i > pos; i-- )
+         parent->kids[i] = parent->kids[i-1];
+      parent->kids[pos] = child;
+      parent->count++;
+      child->parent = parent;
+   }
+
+   // =====================================================================
+
+   void chunk_sequence::move_entries(node* from, size_type at,
+                                     size_type count, node* to,
+                                     size_type to_at)
+
+   // this function opens a gap of count entries at to_at in to, copies
+   // the entries into it, and closes the gap they leave in from
+   {
+      size_type moved = 0;                // # of items moved
+      size_type i;
+
+      if( from->is_leaf )
+      {
+         leaf* f = static_cast<leaf*>(from);
+         leaf* t = static_cast<leaf*>(to);
+         for( i = t->count; i > to_at; i-- )
+            t->items[i-1+count] = t->items[i-1];
+         for( i = 0; i < count; i++ )
+            t->items[to_at+i] = f->items[at+i];
+         for( i = at + count; i < f->count; i++ )
+            f->items[i-count] = f->items[i];
+         moved = count;
+      }
+      else
+      {
+         inner* f = static_cast<inner*>(from);
+         inner* t = static_cast<inner*>(to);
+         for( i = t->count; i > to_at; i-- )
+            t->kids[i-1+count] = t->kids[i-1];
+         for( i = 0; i < count; i++ )
+         {
+            t->kids[to_at+i] = f->kids[at+i];
+            t->kids[to_at+i]->parent = t;
+            moved += t->kids[to_at+i]->total;
+         }
+         for( i = at + count; i < f->count; i++ )
+            f->kids[i-count] = f->kids[i];
+      }
+
+      from->count -= count;
+      to->count += count;
+      from->total -= moved;
+      to->total += moved;
+   }
+}
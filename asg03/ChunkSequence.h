@@ -0,0 +1,127 @@
+// FILE: ChunkSequence.h
+// CLASS PROVIDED: chunk_sequence (part of the namespace CS3358_SSII_2015)
+//
+// chunk_sequence has the interface of sequence (see Sequence.h) for
+// very large sequences (millions of items). Instead of one array, which
+// every insert in the middle shifts and every resize copies in full,
+// the items are kept in fixed-size chunks of up to LEAF_SIZE items,
+// which are the leaves of a balanced tree (a B+ tree with up to
+// FANOUT children per inner node, each inner node knowing how many
+// items are under each child). So:
+//   - insert, attach and remove_current shift at most one chunk, and
+//     split, merge or rebalance chunks and nodes only along one path of
+//     the tree: O(log n).
+//   - seek goes to any position in O(log n).
+//   - advance steps through a chunk, and from one chunk to the next by
+//     a link between them: O(1), and a traversal reads each chunk's
+//     items one after another in memory.
+// Memory is taken one chunk at a time, as needed, so the capacity of
+// sequence has no meaning here (the constructor's argument and resize
+// are only kept so that code written for sequence compiles unchanged).
+//
+// TYPEDEFS and MEMBER CONSTANTS for the chunk_sequence class:
+//   typedef ____ value_type
+//   typedef ____ size_type
+//   static const size_type DEFAULT_CAPACITY = _____
+//    As for sequence.
+//
+//   static const size_type LEAF_SIZE = _____
+//   static const size_type FANOUT = _____
+//    chunk_sequence::LEAF_SIZE is the most items a chunk holds, and
+//    chunk_sequence::FANOUT the most children an inner node has.
+//
+// CONSTRUCTOR for the chunk_sequence class:
+//   chunk_sequence(size_type initial_capacity = DEFAULT_CAPACITY)
+//    Pre:  none
+//    Post: The chunk_sequence has been initialized as an empty sequence.
+//    Note: initial_capacity is not used (see above).
+//
+// MODIFICATION MEMBER FUNCTIONS for the chunk_sequence class:
+//   void resize(size_type new_capacity)
+//    Pre:  none
+//    Post: The chunk_sequence is unchanged (see above).
+//
+//   void start()
+//   void advance()
+//   void insert(const value_type& entry)
+//   void attach(const value_type& entry)
+//   void remove_current()
+//    Pre/Post: As for sequence.
+//
+//   void seek(size_type index)
+//    Pre:  index <= size()
+//    Post: If index < size(), the item at position index (0 being the
+//      first) is the current item; otherwise there is no current item.
+//
+// CONSTANT MEMBER FUNCTIONS for the chunk_sequence class:
+//   size_type size() const
+//   bool is_item() const
+//   value_type current() const
+//    Pre/Post: As for sequence.
+//
+// VALUE SEMANTICS for the chunk_sequence class:
+//   Assignments and the copy constructor may be used with
+//   chunk_sequence objects.
+
+#ifndef CHUNK_SEQUENCE_H
+#define CHUNK_SEQUENCE_H
+#include <cstdlib>  // provides size_t
+
+namespace CS3358_SSII_2015
+{
+   class chunk_sequence
+   {
+   public:
+      // TYPEDEFS and MEMBER CONSTANTS
+      typedef double value_type;
+      typedef std::size_t size_type;
+      static const size_type DEFAULT_CAPACITY = 30;
+      static const size_type LEAF_SIZE = 64;
+      static const size_type FANOUT = 32;
+      // CONSTRUCTORS and DESTRUCTOR
+      chunk_sequence(size_type initial_capacity = DEFAULT_CAPACITY);
+      chunk_sequence(const chunk_sequence& source);
+      ~chunk_sequence();
+      // MODIFICATION MEMBER FUNCTIONS
+      void resize(size_type new_capacity);
+      void start();
+      void advance();
+      void insert(const value_type& entry);
+      void attach(const value_type& entry);
+      void remove_current();
+      void seek(size_type index);
+      chunk_sequence& operator=(const chunk_sequence& source);
+      // CONSTANT MEMBER FUNCTIONS
+      size_type size() const;
+      bool is_item() const;
+      value_type current() const;
+   private:
+      struct node;
+      struct leaf;
+      struct inner;
+      node* root;
+      leaf* head;
+      leaf* tail;
+      size_type used;
+      size_type current_index;
+      leaf* cur_leaf;
+      size_type cur_offset;
+      void clear();
+      void copy_from(const chunk_sequence& source);
+      void locate(size_type index, leaf*& where, size_type& offset) const;
+      void relocate();
+      void insert_at(size_type index, const value_type& entry);
+      void remove_at(size_type index);
+      void split(node* n, bool at_end);
+      void rebalance(node* n);
+      static void free_node(node* n);
+      static void free_tree(node* n);
+      static void add_to_totals(node* n, long delta);
+      static size_type child_index(const inner* parent, const node* child);
+      static void insert_child(inner* parent, size_type pos, node* child);
+      static void move_entries(node* from, size_type at, size_type count,
+                               node* to, size_type to_at);
+   };
+}
+
+#endif
@@ -3,12 +3,20 @@
 // INVARIANT for the sequence ADT:
 //   1. The number of items in the sequence is in the member variable
 //      used;
-//   2. The actual items of the sequence are stored in a partially
-//      filled array. The array is a dynamic array, pointed to by
-//      the member variable data. For an empty sequence, we do not
-//      care what is stored in any of data; for a non-empty sequence
-//      the items in the sequence are stored in data[0] through
-//      data[used-1], and we don't care what's in the rest of data.
+//   2. The actual items of the sequence are stored in a "gap buffer":
+//      a dynamic array, pointed to by the member variable data, whose
+//      capacity - used unused places (the "gap") form one block with
+//      after_gap items after it. The used - after_gap items before the
+//      gap are stored in order in data[0] onward, and the after_gap
+//      items after it in order in data[capacity-after_gap] through
+//      data[capacity-1] (see slot()); we don't care what's in the gap.
+//      NOTE: With after_gap == 0 this is the plain partially filled
+//            array (items in data[0] through data[used-1]). The gap
+//            is moved to wherever an item is inserted or removed, and
+//            stays there, so a run of inserts, attaches or removals
+//            around the current item moves only the few items between
+//            one place and the next (O(1) each), instead of shifting
+//            every item after the current one each time.
 //   3. The size of the dynamic array is in the member variable
 //      capacity.
 //   4. The index of the current item is in the member variable
@@ -37,6 +45,22 @@
 //                postcondition for the function for both of the two
 //                possible scenarios (current item is and is not the
 //                last item in the sequence).
+//   5. after_gap <= used.
+//
+// DOCUMENTATION for private member (helper) functions:
+//   size_type slot(size_type index) const
+//    Pre:  index < used
+//    Post: The place in data of the item at position index is returned.
+//   void move_gap(size_type index)
+//    Pre:  index <= used
+//    Post: The gap starts at data[index] (the items before position
+//      index are in data[0] through data[index-1], so after_gap is
+//      used - index); only the items between the old and the new
+//      start of the gap have been moved.
+//   void make_room()
+//    Pre:  none
+//    Post: capacity > used (the array has been grown by a quarter if
+//      it was full).
 
 #include <cassert>
 #include "Sequence.h"
@@ -48,7 +72,7 @@ namespace CS3358_SSII_2015
    // =====================================================================
 
    sequence::sequence(size_type initial_capacity)
-   :used(0), current_index(used), capacity(initial_capacity)
+   :used(0), current_index(used), capacity(initial_capacity), after_gap(0)
 
    // this function is a parameterized constructor for the sequence class
    {
@@ -61,14 +85,20 @@ namespace CS3358_SSII_2015
    // =====================================================================
    
    sequence::sequence(const sequence& source)
-   :used(source.used), current_index(source.current_index), capacity(source.capacity)
+   :used(source.used), current_index(source.current_index), capacity(source.capacity),
+    after_gap(source.after_gap)
 
-   // this function is a copy constructor for the sequence class;
+   // this function is a copy constructor for the sequence class; the
+   // copy has the same capacity, so its gap is at the same place
    {
       data = new value_type[capacity]; 
 
       size_type i; 
-      for( i = 0; i < source.used; i++ )
+      for( i = 0; i < used - after_gap; i++ )
+      {
+         data[i] = source.data[i];
+      }
+      for( i = capacity - after_gap; i < capacity; i++ )
       {
          data[i] = source.data[i];
       }
@@ -87,35 +117,31 @@ namespace CS3358_SSII_2015
 
    void sequence::resize(size_type new_capacity)
 
-   // this function copies "this" into a temp object of the desired capacity,
-   // deletes stale data memory (via the overloaded assignment operator), 
-   // and returns the re-sized object reference to the caller
+   // this function copies the items into a new array of the desired
+   // capacity (the items before the gap at its front, the rest at its
+   // end, so the gap stays where it was, only wider or narrower) and
+   // deletes the stale data memory
    {
       if( new_capacity < used )           // ensure new_capacity is big                          
          new_capacity = used;             // enough for current contents
       
       if( new_capacity <= 0 )             // ensure pre-condition is met
          new_capacity = 1;                // s.t. new_capacity > 0
-   
-      
-      // create temp object w/new_capacity to hold "this" contents
-      sequence tempSeq(new_capacity);
-      tempSeq.used = used;
-      tempSeq.current_index = current_index;
-     
-      // copy data from "this" into tempSeq
+
+      value_type* new_data = new value_type[new_capacity];
       size_type i;
-      for( i = 0 ; i < used; i++ )
+      for( i = 0; i < used - after_gap; i++ )
       {
-         tempSeq.data[i] = data[i];
+         new_data[i] = data[i];
       }
-	
-      // send "this" and tempSeq objects to the operator=() function to
-      //    * copy the tempSeq obj back into "this" 
-      //    * repoint the "this" data pointer to the new memory store
-      //    * delete stale memory
-      
-      *this = tempSeq;
+      for( i = 0; i < after_gap; i++ )
+      {
+         new_data[new_capacity - after_gap + i] = data[capacity - after_gap + i];
+      }
+
+      delete [] data;
+      data = new_data;
+      capacity = new_capacity;
    }
 
    // =====================================================================
@@ -159,58 +185,19 @@ namespace CS3358_SSII_2015
    // the current item; if there was no current item, the new entry goes
    // at the front of the sequence; in either case, the entry becomes the
    // new current item
+   // METHOD: move the gap to the insertion point and put the entry in
+   // its first place; the gap is then just after the new current item,
+   // one item away from where the next insert will want it
    {
-      // resize array if capacity is too small for entry 
-      if( (used + 1) > capacity )
-      {
-         size_type nuCapacity = capacity * 1.25;
-                                                
-         if( nuCapacity == capacity )
-            nuCapacity = capacity + 1;
-
-         resize(nuCapacity);
-      }
-
+      make_room();
 
-      // insert the entry value into the array:
-
-      // CASE 1: if there is no current item because the array 
-      // is empty, then put the entry in the first index
-      // NOTE: in this case, current_index is already 0
-      if( used == 0 )                
-      {
-         data[current_index] = entry;               
-         used++;
-      }
+      if( !is_item() )                    // no current item: insert at
+         current_index = 0;               // the front of the sequence
 
-      // CASE 2: if array is not empty, then insert entry before
-      // the current item; if there is no current item, then 
-      // insert entry at front of sequence;
-      // METHOD: beginning at current item (if there is one) 
-      // or at index[0] (if there's no current item), scoot the 
-      // elements to the right by one index, then insert the
-      // entry value into the hole created by the shift
-      // NOTE: the newly inserted item is now the current item
-      else                                 
-      {
-         size_type END;
-         if( is_item() )                  // set END = current item
-            END = current_index;          // if there is one   
-         else
-         {
-            END = 0;                      // else END = 0 = insertion point 
-            current_index = END;				 
-		   }
-		   
-         size_type i;
-         for( i = used; i > END; i-- )
-         {
-            data[i] = data[i-1];
-         }
-         data[END] = entry;
-         used++;
-      }
-}
+      move_gap(current_index);
+      data[current_index] = entry;        // (the gap's first place)
+      used++;
+   }
 
    // =====================================================================
    
@@ -220,62 +207,20 @@ namespace CS3358_SSII_2015
    // the current item; if there was no current item, the new entry goes
    // at the end of the sequence; in either case, the entry becomes the
    // new current item
+   // METHOD: as for insert, with the insertion point just after the
+   // current item (or at the end); the gap is then just after the new
+   // current item, which is exactly where the next attach will want it
    {
-      // resize array if capacity is too small for entry 
-      if( (used + 1) > capacity )
-      {
-         size_type nuCapacity = capacity * 1.25;
-                                                
-         if( nuCapacity == capacity )
-            nuCapacity = capacity + 1;
-
-         resize(nuCapacity);
-      }
-
+      make_room();
 
-      // attach the entry value into the array:
-
-      // CASE 1: if there is no current item because the array 
-      // is empty, then put the entry in the first index
-      // NOTE: in this case, current_index is already 0
-      if( used == 0 )                
-      {
-         data[current_index] = entry;               
-         used++;
-      }
-      
-      // CASE 2: if array is not empty and there is no current
-      // item, then insert entry at end of sequence and make
-      // it the current item
-      else if( !is_item() )
-      {
-         data[used] = entry;        
-         used++;
-         current_index = (used-1);
-      }
+      if( is_item() )                     // attach after the current
+         current_index++;                 // item, or at the end of the
+      else                                // sequence if there is none
+         current_index = used;
 
-      // CASE 3: if array is not empty and current item exists,
-      // then attach entry after the current item and set the
-      // attached entry value to be the new current item
-      // METHOD: beginning at current item + 1, scoot the 
-      // elements to the right by one index, then insert the
-      // entry value into the hole created by the shift, then
-      // increment current_index
-      else                                 
-      {
-         const size_type START = used;       // new final index 
-         size_type END = (current_index+1);  // if there is one   
-         size_type here = START;
-         size_type i;
-         for( i = START; i > END; i-- )
-         {
-            data[here] = data[here-1];
-            here--;
-         }
-         data[END] = entry;
-         used++;
-         current_index++;
-      }
+      move_gap(current_index);
+      data[current_index] = entry;        // (the gap's first place)
+      used++;
    }
 
    // =====================================================================
@@ -286,31 +231,20 @@ namespace CS3358_SSII_2015
    // sets the next item to be the current item; if the user-entered value
    // was already at the end of the sequence, then there is no longer a 
    // current value;
+   // METHOD: move the gap to the current item and widen it by one place
+   // to swallow the item; the item after it (if any) is then the first
+   // one after the gap, and keeps the same index, current_index
    {
       // PRE-CONDITION: is_item returns true	  
       if( is_item() )
       {
-         // CASE 1: if the current item is the last one in the sequence,
-         // effectively remove it by decrementing used and setting the 
-         // current_index = used (i.e., there's no longer a current item)
-         if( (current_index + 1) == used )          
-         {                                   
-            used--;
-            current_index = used;
-         }
-         // CASE 2: the current item is not the last one in the sequence
-         else
-         {
-            size_type i;
-            for( i = current_index; i < used; i++ )
-            {
-               data[i] = data[i+1];
-            } 
-            used--;
-         }
+         move_gap(current_index);
+         used--;                          // (the gap, capacity - used,
+         after_gap--;                     //  is now one place wider)
       }
-   }
-
+   }                                      // NOTE: if the removed item was
+                                          // the last one, current_index
+                                          // == used: no current item
    // =====================================================================
    
    sequence& sequence::operator=(const sequence& source)
@@ -328,9 +262,14 @@ namespace CS3358_SSII_2015
       data = new value_type[capacity];  
       used = source.used;
       current_index = source.current_index;      
+      after_gap = source.after_gap;
       size_type i;
     
-      for( i = 0; i < used; i++ )   
+      for( i = 0; i < used - after_gap; i++ )   
+      {
+         data[i] = source.data[i];
+      }
+      for( i = capacity - after_gap; i < capacity; i++ )
       {
          data[i] = source.data[i];
       }
@@ -362,7 +301,57 @@ namespace CS3358_SSII_2015
    {
       assert( is_item() );
 
-      return data[current_index];
+      return data[slot(current_index)];
+   }
+
+   // =====================================================================
+
+   sequence::size_type sequence::slot(size_type index) const
+   {
+      return ( index < used - after_gap ) ? index : index + (capacity - used);
+   }
+
+   // =====================================================================
+
+   void sequence::move_gap(size_type index)
+
+   // this function moves the items between the old and the new start of
+   // the gap across it: to the end of the gap (moving it toward the
+   // front), or to the start of the gap (moving it toward the back)
+   {
+      size_type gap = capacity - used;
+      size_type gap_start = used - after_gap;
+      size_type i;
+
+      if( gap > 0 )                       // (a full array has no gap,
+      {                                   // so nothing to move)
+         for( i = gap_start; i > index; i-- )
+         {
+            data[i - 1 + gap] = data[i - 1];
+         }
+         for( i = gap_start; i < index; i++ )
+         {
+            data[i] = data[i + gap];
+         }
+      }
+      after_gap = used - index;
+   }
+
+   // =====================================================================
+
+   void sequence::make_room()
+
+   // this function grows a full array by a quarter (at least one place)
+   {
+      if( (used + 1) > capacity )
+      {
+         size_type nuCapacity = capacity * 1.25;
+                                                
+         if( nuCapacity == capacity )
+            nuCapacity = capacity + 1;
+
+         resize(nuCapacity);
+      }
    }
 }
 
@@ -124,6 +124,10 @@ namespace CS3358_SSII_2015
       size_type used;
       size_type current_index;
       size_type capacity;
+      size_type after_gap;
+      size_type slot(size_type index) const;
+      void move_gap(size_type index);
+      void make_room();
    };
 }
 
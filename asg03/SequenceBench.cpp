@@ -0,0 +1,137 @@
+// FILE: SequenceBench.cpp
+//       A benchmark of chunk_sequence (see ChunkSequence.h) on a very
+//       large sequence.
+//
+// DESCRIPTION:
+// A chunk_sequence of NUM_ITEMS items (3,000,000 by default) is built by
+// attach, copied and traversed; then ROUNDS rounds (200,000 by default)
+// each seek to a random position and insert an item there, and seek to
+// another and remove the item there (so the size stays the same), and
+// as many more seeks to random positions are timed alone. The items are
+// checked (by their sum) after each step, and each step's total time,
+// and its time per item or per round, is written to cout.
+// Usage: sbench [NUM_ITEMS [ROUNDS]]
+
+#include "ChunkSequence.h"
+#include <cstdlib>
+#include <iostream>
+#include <sys/time.h>
+using namespace std;
+using namespace CS3358_SSII_2015;
+
+const long DEFAULT_ITEMS = 3000000;
+const long DEFAULT_ROUNDS = 200000;
+
+double seconds();
+// Post: The current time, in seconds since some fixed moment, is
+//       returned (with microsecond resolution).
+
+long nextRandom(long bound);
+// Pre:  bound >= 1
+// Post: A pseudo-random number in [0, bound) is returned (made of two
+//       calls to rand, so that bound may be well over RAND_MAX).
+
+double sumOf(chunk_sequence& s);
+// Post: The sum of the items of s is returned (with no current item).
+
+void report(const char* step, double secs, long count, const char* per);
+// Post: The step's time, and its time per count, have been written to
+//       cout.
+
+int main(int argc, char* argv[])
+{
+   long numItems = ( argc > 1 ) ? atol(argv[1]) : DEFAULT_ITEMS;
+   long rounds = ( argc > 2 ) ? atol(argv[2]) : DEFAULT_ROUNDS;
+   if( numItems < 1 || rounds < 0 )
+   {
+      cerr << "usage: sbench [NUM_ITEMS [ROUNDS]]" << endl;
+      return EXIT_FAILURE;
+   }
+
+   srand(3358);
+   chunk_sequence s;
+   double t = seconds();
+   for( long i = 0; i < numItems; i ++ )
+      s.attach(i);
+   report("attach", seconds() - t, numItems, "item");
+
+   double expected = 0.5 * numItems * ( numItems - 1 );
+   t = seconds();
+   double sum = sumOf(s);
+   report("traverse", seconds() - t, numItems, "item");
+
+   t = seconds();
+   chunk_sequence copy(s);
+   report("copy", seconds() - t, numItems, "item");
+   if( sum != expected || sumOf(copy) != expected )
+   {
+      cerr << "sbench: wrong items after attach or copy" << endl;
+      return EXIT_FAILURE;
+   }
+
+   // each round adds -1 and takes away one item (whose value is kept
+   // track of) at random, so the expected sum stays known
+   t = seconds();
+   for( long r = 0; r < rounds; r ++ )
+   {
+      s.seek(nextRandom(s.size() + 1));
+      s.insert(-1);
+      s.seek(nextRandom(s.size()));
+      expected += -1 - s.current();
+      s.remove_current();
+   }
+   report("seek+insert+seek+remove", seconds() - t, rounds, "round");
+   if( s.size() != static_cast<size_t>(numItems) || sumOf(s) != expected )
+   {
+      cerr << "sbench: wrong items after the insert/remove rounds" << endl;
+      return EXIT_FAILURE;
+   }
+
+   double check = 0;
+   t = seconds();
+   for( long r = 0; r < rounds; r ++ )
+   {
+      s.seek(nextRandom(s.size()));
+      check += s.current();
+   }
+   report("seek", seconds() - t, rounds, "seek");
+   cout << "(checksum " << check << ")" << endl;
+   return EXIT_SUCCESS;
+}
+
+// ==========================================================================
+
+double seconds()
+{
+   timeval tv;
+   gettimeofday(&tv, 0);
+   return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+// ==========================================================================
+
+long nextRandom(long bound)
+{
+   double r = ( rand() / ( RAND_MAX + 1.0 ) + rand() ) / ( RAND_MAX + 1.0 );
+   return static_cast<long>( r * bound );
+}
+
+// ==========================================================================
+
+double sumOf(chunk_sequence& s)
+{
+   double sum = 0;
+   for( s.start(); s.is_item(); s.advance() )
+      sum += s.current();
+   return sum;
+}
+
+// ==========================================================================
+
+void report(const char* step, double secs, long count, const char* per)
+{
+   cout << step << ": " << secs << " s";
+   if( count > 0 )
+      cout << ", " << 1e9 * secs / count << " ns/" << per;
+   cout << endl;
+}